@@ -2,16 +2,53 @@
 
 using namespace maaaaap;
 
-ofMesh WarpingMesh::getMesh() const
+const ofMesh& WarpingMesh::getMesh() const
 {
-	ofMesh ret = mesh_->getMesh();
-	for(auto &coord : ret.getTexCoords()) {
-		geom::remapPosition({0,0,1,1}, texcoord_range_, coord);
+	auto version = getVersion();
+	if(!is_cached_ || cache_version_ != version) {
+		cache_ = mesh_->getMesh();
+		for(auto &coord : cache_.getTexCoords()) {
+			geom::remapPosition({0,0,1,1}, texcoord_range_, coord);
+		}
+		cache_version_ = version;
+		is_cached_ = true;
 	}
-	return ret;
+	return cache_;
 }
 
-ofMesh BlendingMesh::getMesh() const
+std::size_t WarpingMesh::getVersion() const
 {
-	return ofxBlendScreen::createMesh(vertex_outer_, vertex_inner_, vertex_frame_, texture_uv_for_frame_);
+	if(texcoord_range_ != texcoord_range_seen_) {
+		texcoord_range_seen_ = texcoord_range_;
+		++version_;
+	}
+	return version_;
+}
+
+std::size_t BlendingMesh::getVersion() const
+{
+	if(vertex_outer_ != seen_[0] || vertex_inner_ != seen_[1] || vertex_frame_ != seen_[2] || texture_uv_for_frame_ != seen_[3]) {
+		seen_[0] = vertex_outer_;
+		seen_[1] = vertex_inner_;
+		seen_[2] = vertex_frame_;
+		seen_[3] = texture_uv_for_frame_;
+		++version_;
+	}
+	return version_;
+}
+
+const ofMesh& BlendingMesh::getMesh() const
+{
+	auto version = getVersion();
+	if(!is_cached_ || cache_version_ != version) {
+		cache_ = ofxBlendScreen::createMesh(vertex_outer_, vertex_inner_, vertex_frame_, texture_uv_for_frame_);
+		auto &&vertices = cache_.getVertices();
+		bounds_ = vertices.empty() ? ofRectangle() : ofRectangle(vertices[0], 0, 0);
+		for(auto &&v : vertices) {
+			bounds_.growToInclude(v);
+		}
+		cache_version_ = version;
+		is_cached_ = true;
+	}
+	return cache_;
 }
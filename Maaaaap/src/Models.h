@@ -9,22 +9,31 @@
 #include "Quad.h"
 
 namespace maaaaap {
+// versions below count content changes, so the render graph can tell what has to be drawn again.
 class Footage : public ofBaseHasTexture
 {
 public:
 	virtual void setUseTexture(bool) override {}
 	virtual bool isUsingTexture() const override { return true; }
+	// bumped whenever the texture gets new content(a new frame, a reload)
+	std::size_t getVersion() const { return version_; }
+protected:
+	std::size_t version_=0;
 };
 class ImageFile : public Footage
 {
 public:
 	void load(const std::string &filepath) {
 		ofLoadImage(texture_, filepath);
+		filepath_ = filepath;
+		++version_;
 	}
+	const std::string& getFilePath() const { return filepath_; }
 	ofTexture& getTexture() override { return texture_; }
 	const ofTexture& getTexture() const override { return texture_; }
 protected:
 	ofTexture texture_;
+	std::string filepath_;
 };
 
 class TextureOut : public Footage
@@ -42,6 +51,7 @@ public:
 	}
 	void end() override {
 		fbo_.end();
+		++version_;
 	}
 	ofTexture& getTexture() override { return fbo_.getTexture(); }
 	const ofTexture& getTexture() const override { return fbo_.getTexture(); }
@@ -52,21 +62,33 @@ protected:
 class Source
 {
 public:
-	void set(std::shared_ptr<Footage> tex) { texture_ = tex; }
+	void set(std::shared_ptr<Footage> tex) { texture_ = tex; ++version_; }
 	std::shared_ptr<Footage> get() { return texture_; }
 	ofTexture getTexture() { return texture_->getTexture(); }
+	// changes when another footage is set; the footage has its own for its frames
+	std::size_t getVersion() const { return version_; }
 protected:
 	std::shared_ptr<Footage> texture_;
+	std::size_t version_=0;
 };
 class WarpingMesh
 {
 public:
-	void set(std::shared_ptr<ofx::mapper::Mesh> mesh) { mesh_ = mesh; }
+	void set(std::shared_ptr<ofx::mapper::Mesh> mesh) { mesh_ = mesh; ++version_; }
 	std::shared_ptr<ofx::mapper::Mesh> get() { return mesh_; }
-	ofMesh getMesh() const;
+	// texcoords remapped into texcoord_range_. kept until the version changes.
+	const ofMesh& getMesh() const;
+	// call after moving points of get(). edits of texcoord_range_ are noticed by themselves.
+	void touch() { ++version_; }
+	std::size_t getVersion() const;
 	geom::Quad texcoord_range_;
 protected:
 	std::shared_ptr<ofx::mapper::Mesh> mesh_;
+	mutable std::size_t version_=0;
+	mutable geom::Quad texcoord_range_seen_;
+	mutable ofMesh cache_;
+	mutable std::size_t cache_version_=0;
+	mutable bool is_cached_=false;
 };
 class RenderTexture
 {
@@ -76,6 +98,7 @@ public:
 	void set(std::shared_ptr<Fbo> fbo) { fbo_ = fbo; }
 	std::shared_ptr<Fbo> get() const { return fbo_; }
 	ofTexture getTexture() { return fbo_->getTexture(); }
+	std::size_t getVersion() const { return fbo_ ? fbo_->getVersion() : 0; }
 protected:
 	std::shared_ptr<Fbo> fbo_;
 };
@@ -86,12 +109,33 @@ public:
 	geom::Quad vertex_inner_;
 	geom::Quad vertex_frame_;
 	geom::Quad texture_uv_for_frame_;
-	ofMesh getMesh() const;
+	// bumped when any of the quads above moves
+	std::size_t getVersion() const;
+	// kept until the version changes
+	const ofMesh& getMesh() const;
+	// of the vertices of getMesh()
+	const ofRectangle& getBounds() const { getMesh(); return bounds_; }
+protected:
+	mutable geom::Quad seen_[4];
+	mutable std::size_t version_=0;
+	mutable ofMesh cache_;
+	mutable ofRectangle bounds_;
+	mutable std::size_t cache_version_=0;
+	mutable bool is_cached_=false;
 };
 class Output
 {
 public:
+	void begin() { fbo_->begin(); }
+	void end() { fbo_->end(); }
+	void set(std::shared_ptr<Fbo> fbo) { fbo_ = fbo; }
+	std::shared_ptr<Fbo> get() const { return fbo_; }
+	ofTexture getTexture() { return fbo_->getTexture(); }
+	// the region of the blending space this output shows, e.g. one projector of a wide window
+	void setRect(const ofRectangle &rect) { rect_ = rect; }
+	const ofRectangle& getRect() const { return rect_; }
 protected:
+	std::shared_ptr<Fbo> fbo_;
 	ofRectangle rect_;
 };
 }
@@ -0,0 +1,78 @@
+#include "OutputRenderer.h"
+#include "ofGraphics.h"
+#include "ofUtils.h"
+#include <algorithm>
+
+using namespace maaaaap;
+
+void OutputRenderer::collect(ResourceStorage &storage, std::shared_ptr<Output> output, OutputStats &stats)
+{
+	// emptied in place, so the vectors keep their capacity
+	for(std::size_t i = 0; i < num_batches_; ++i) {
+		batches_[i].source = nullptr;
+		batches_[i].blends.clear();
+	}
+	num_batches_ = 0;
+	auto &&rect = output->getRect();
+	for(auto &&blend : storage.getBlendsBoundTo(output)) {
+		auto source = storage.getRenderTextureReferencedBy(blend);
+		if(!source || !blend->getBounds().intersects(rect)) {
+			++stats.num_culled;
+			continue;
+		}
+		auto batch = std::find_if(begin(batches_), begin(batches_)+num_batches_, [&source](const Batch &b) { return b.source == source; });
+		if(batch == begin(batches_)+num_batches_) {
+			if(num_batches_ == batches_.size()) {
+				batches_.emplace_back();
+			}
+			batch = begin(batches_)+num_batches_++;
+			batch->source = source;
+		}
+		batch->blends.push_back(blend);
+		++stats.num_drawn;
+	}
+	stats.num_batches = num_batches_;
+}
+
+void OutputRenderer::draw(Output &output, ofxBlendScreen::Shader &shader)
+{
+	auto &&rect = output.getRect();
+	output.begin();
+	ofClear(0);
+	ofPushMatrix();
+	ofTranslate(-rect.x, -rect.y);
+	for(std::size_t i = 0; i < num_batches_; ++i) {
+		auto &&batch = batches_[i];
+		shader.begin(batch.source->getTexture());
+		for(auto &&blend : batch.blends) {
+			blend->getMesh().draw();
+		}
+		shader.end();
+	}
+	ofPopMatrix();
+	output.end();
+}
+
+void OutputRenderer::render(ResourceStorage &storage, ofxBlendScreen::Shader &shader)
+{
+	auto &outputs = storage.getContainer<Output>();
+	stats_.outputs.resize(outputs.size());
+	stats_.micros = 0;
+	std::size_t i = 0;
+	for(auto &&o : outputs) {
+		auto &stats = stats_.outputs[i++];
+		stats = OutputStats();
+		stats.output = o;
+		if(!o->get()) {
+			continue;
+		}
+		auto start = ofGetElapsedTimeMicros();
+		collect(storage, o, stats);
+		auto collected = ofGetElapsedTimeMicros();
+		draw(*o, shader);
+		auto drawn = ofGetElapsedTimeMicros();
+		stats.cull_micros = collected-start;
+		stats.draw_micros = drawn-collected;
+		stats_.micros += drawn-start;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ResourceStorage.h"
+#include "ofxBlendScreen.h"
+#include <cstdint>
+
+namespace maaaaap {
+// draws the blending meshes bound to each output into the output's own fbo, in the output's rect.
+// meshes whose bounds miss the rect are culled, the rest are drawn in batches sharing a render
+// texture, so the shader is bound once per texture and output. outputs without an fbo are skipped.
+class OutputRenderer
+{
+public:
+	struct OutputStats {
+		std::shared_ptr<Output> output;
+		std::size_t num_drawn=0, num_culled=0, num_batches=0;
+		std::uint64_t cull_micros=0;	// building the batches
+		std::uint64_t draw_micros=0;	// cpu time submitting them
+	};
+	struct Stats {
+		std::vector<OutputStats> outputs;
+		std::uint64_t micros=0;
+	};
+	void render(ResourceStorage &storage, ofxBlendScreen::Shader &shader);
+	const Stats& getStats() const { return stats_; }
+private:
+	struct Batch {
+		std::shared_ptr<RenderTexture> source;
+		std::vector<std::shared_ptr<BlendingMesh>> blends;
+	};
+	// reused across outputs and frames
+	std::vector<Batch> batches_;
+	std::size_t num_batches_=0;
+	Stats stats_;
+
+	void collect(ResourceStorage &storage, std::shared_ptr<Output> output, OutputStats &stats);
+	void draw(Output &output, ofxBlendScreen::Shader &shader);
+};
+}
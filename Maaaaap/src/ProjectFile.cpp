@@ -0,0 +1,337 @@
+#include "ProjectFile.h"
+#include "MappedFile.h"
+#include "Bytes.h"
+#include "ofLog.h"
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <limits>
+#include <cstring>
+
+using namespace maaaaap;
+
+namespace {
+const char MAGIC[4] = {'M','G','P','J'};
+const std::uint32_t VERSION = 1;
+enum SourceKind : std::uint32_t {
+	SOURCE_NONE,
+	SOURCE_IMAGE,
+	SOURCE_RENDER_TEXTURE,	// ref is the id of the render texture whose fbo it shows
+};
+enum {
+	SOURCE, WARP, TARGET, BLEND, OUTPUT,
+	NUM_KINDS
+};
+enum {
+	WARP_SOURCE, WARP_TARGET, BLEND_TARGET, BLEND_OUTPUT,
+	NUM_RELATIONS
+};
+
+void putQuad(std::vector<float> &dst, const geom::Quad &quad) {
+	for(auto &&p : quad.pt) {
+		dst.push_back(p.x);
+		dst.push_back(p.y);
+	}
+}
+geom::Quad getQuad(const float *src) {
+	return geom::Quad(glm::vec2(src[0],src[1]), glm::vec2(src[2],src[3]), glm::vec2(src[4],src[5]), glm::vec2(src[6],src[7]));
+}
+std::vector<std::uint32_t> fboInfo(std::uint32_t id, const std::shared_ptr<Fbo> &fbo) {
+	if(!fbo || !fbo->get().isAllocated()) {
+		return {id, 0, 0, 0};
+	}
+	auto &&tex = fbo->get().getTexture().getTextureData();
+	return {id, (std::uint32_t)fbo->get().getWidth(), (std::uint32_t)fbo->get().getHeight(), (std::uint32_t)tex.glInternalFormat};
+}
+std::shared_ptr<Fbo> makeFbo(const std::uint32_t *info) {
+	auto fbo = std::make_shared<Fbo>();
+	if(info[1] > 0 && info[2] > 0) {
+		fbo->get().allocate(info[1], info[2], info[3]);
+	}
+	return fbo;
+}
+}
+
+bool maaaaap::saveProject(const ResourceStorage &storage, const std::filesystem::path &filepath)
+{
+	auto &sources = storage.getContainer<Source>();
+	auto &warps = storage.getContainer<WarpingMesh>();
+	auto &targets = storage.getContainer<RenderTexture>();
+	auto &blends = storage.getContainer<BlendingMesh>();
+	auto &outputs = storage.getContainer<Output>();
+
+	std::vector<std::uint32_t> target_table, output_table, source_table, warp_table, blend_ids;
+	std::vector<float> output_rects, warp_ranges, vertices, texcoords, blend_quads;
+	std::string strings;
+	std::vector<std::uint32_t> bindings[NUM_RELATIONS];
+	auto bindTo = [&](int relation, std::uint32_t a, std::uint32_t b) {
+		if(a != 0 && b != 0) {
+			bindings[relation].push_back(a);
+			bindings[relation].push_back(b);
+		}
+	};
+
+	for(auto &&r : targets) {
+		auto info = fboInfo(storage.getId(r), r->get());
+		target_table.insert(end(target_table), begin(info), end(info));
+	}
+	for(auto &&o : outputs) {
+		auto info = fboInfo(storage.getId(o), o->get());
+		output_table.insert(end(output_table), begin(info), end(info));
+		auto &&rect = o->getRect();
+		output_rects.insert(end(output_rects), {rect.x, rect.y, rect.width, rect.height});
+	}
+	for(auto &&s : sources) {
+		std::uint32_t kind = SOURCE_NONE, ref = 0, offset = strings.size(), size = 0;
+		auto footage = s->get();
+		if(auto image = std::dynamic_pointer_cast<ImageFile>(footage)) {
+			kind = SOURCE_IMAGE;
+			strings += image->getFilePath();
+			size = image->getFilePath().size();
+		}
+		else if(footage) {
+			for(auto &&r : targets) {
+				if(r->get() == footage) {
+					kind = SOURCE_RENDER_TEXTURE;
+					ref = storage.getId(r);
+					break;
+				}
+			}
+			if(kind == SOURCE_NONE) {
+				ofLogWarning("ProjectFile") << "source " << storage.getId(s) << " saved empty, its footage is neither an image file nor a render texture";
+			}
+		}
+		source_table.insert(end(source_table), {storage.getId(s), kind, ref, offset, size});
+	}
+	for(auto &&w : warps) {
+		auto mesh = w->get();
+		std::uint32_t cols = mesh ? mesh->getNumCols() : 0, rows = mesh ? mesh->getNumRows() : 0;
+		std::uint32_t offset = vertices.size()/3;
+		if(mesh) {
+			for(std::uint32_t r = 0; r <= rows; ++r) {
+				for(std::uint32_t c = 0; c <= cols; ++c) {
+					auto point = mesh->getPoint(c, r);
+					vertices.insert(end(vertices), {point.v->x, point.v->y, point.v->z});
+					texcoords.insert(end(texcoords), {point.t->x, point.t->y});
+				}
+			}
+		}
+		warp_table.insert(end(warp_table), {storage.getId(w), mesh ? cols : 0xffffffffu, rows, offset});
+		putQuad(warp_ranges, w->texcoord_range_);
+		bindTo(WARP_SOURCE, storage.getId(w), storage.getId(storage.getSourceFor(w)));
+		bindTo(WARP_TARGET, storage.getId(w), storage.getId(storage.getRenderTextureIncluding(w)));
+	}
+	for(auto &&b : blends) {
+		blend_ids.push_back(storage.getId(b));
+		putQuad(blend_quads, b->vertex_outer_);
+		putQuad(blend_quads, b->vertex_inner_);
+		putQuad(blend_quads, b->vertex_frame_);
+		putQuad(blend_quads, b->texture_uv_for_frame_);
+		bindTo(BLEND_TARGET, storage.getId(b), storage.getId(storage.getRenderTextureReferencedBy(b)));
+		bindTo(BLEND_OUTPUT, storage.getId(b), storage.getId(storage.getOutputFor(b)));
+	}
+
+	ByteWriter writer;
+	writer.putBytes(MAGIC, 4);
+	writer.put(VERSION);
+	std::uint32_t counts[NUM_KINDS] = {(std::uint32_t)sources.size(), (std::uint32_t)warps.size(), (std::uint32_t)targets.size(), (std::uint32_t)blends.size(), (std::uint32_t)outputs.size()};
+	writer.putArray(counts, NUM_KINDS);
+	std::uint32_t num_bindings[NUM_RELATIONS];
+	for(int i = 0; i < NUM_RELATIONS; ++i) {
+		num_bindings[i] = bindings[i].size()/2;
+	}
+	writer.putArray(num_bindings, NUM_RELATIONS);
+	std::uint32_t sizes[2] = {(std::uint32_t)strings.size(), (std::uint32_t)vertices.size()/3};
+	writer.putArray(sizes, 2);
+	writer.putArray(target_table.data(), target_table.size());
+	writer.putArray(output_table.data(), output_table.size());
+	writer.putArray(output_rects.data(), output_rects.size());
+	writer.putArray(source_table.data(), source_table.size());
+	writer.putArray(strings.data(), strings.size());
+	writer.putArray(warp_table.data(), warp_table.size());
+	writer.putArray(warp_ranges.data(), warp_ranges.size());
+	writer.putArray(vertices.data(), vertices.size());
+	writer.putArray(texcoords.data(), texcoords.size());
+	writer.putArray(blend_ids.data(), blend_ids.size());
+	writer.putArray(blend_quads.data(), blend_quads.size());
+	for(auto &&b : bindings) {
+		writer.putArray(b.data(), b.size());
+	}
+
+	std::ofstream file(filepath, std::ios::binary);
+	if(!file.write(writer.data(), writer.size())) {
+		ofLogError("ProjectFile") << "failed to write: " << filepath;
+		return false;
+	}
+	return true;
+}
+
+bool maaaaap::loadProject(const std::filesystem::path &filepath, ResourceStorage &storage)
+{
+	MappedFile file(filepath);
+	if(!file.isOpen()) {
+		ofLogError("ProjectFile") << "failed to open: " << filepath;
+		return false;
+	}
+	ByteReader reader(file.data(), file.size());
+	char magic[4];
+	std::uint32_t version;
+	if(!reader.getBytes(magic, 4) || memcmp(magic, MAGIC, 4) != 0 || !reader.get(version) || version != VERSION) {
+		ofLogError("ProjectFile") << "not a project file: " << filepath;
+		return false;
+	}
+	std::uint32_t counts[NUM_KINDS], num_bindings[NUM_RELATIONS], sizes[2];
+	reader.getArray(counts, NUM_KINDS);
+	reader.getArray(num_bindings, NUM_RELATIONS);
+	reader.getArray(sizes, 2);
+	const std::size_t num_points = sizes[1];
+	std::vector<std::uint32_t> target_table, output_table, source_table, warp_table, blend_ids;
+	std::vector<float> output_rects, warp_ranges, vertices, texcoords, blend_quads;
+	std::vector<char> strings;
+	std::vector<std::uint32_t> bindings[NUM_RELATIONS];
+	reader.getArray(target_table, std::size_t(counts[TARGET])*4);
+	reader.getArray(output_table, std::size_t(counts[OUTPUT])*4);
+	reader.getArray(output_rects, std::size_t(counts[OUTPUT])*4);
+	reader.getArray(source_table, std::size_t(counts[SOURCE])*5);
+	reader.getArray(strings, sizes[0]);
+	reader.getArray(warp_table, std::size_t(counts[WARP])*4);
+	reader.getArray(warp_ranges, std::size_t(counts[WARP])*8);
+	reader.getArray(vertices, num_points*3);
+	reader.getArray(texcoords, num_points*2);
+	reader.getArray(blend_ids, counts[BLEND]);
+	reader.getArray(blend_quads, std::size_t(counts[BLEND])*32);
+	for(int i = 0; i < NUM_RELATIONS; ++i) {
+		reader.getArray(bindings[i], std::size_t(num_bindings[i])*2);
+	}
+	if(!reader.good()) {
+		ofLogError("ProjectFile") << "truncated project file: " << filepath;
+		return false;
+	}
+
+	// everything goes into a fresh storage first, so a broken file leaves the current one alone
+	ResourceStorage loaded;
+	std::unordered_map<std::uint32_t, std::shared_ptr<Source>> source_of;
+	std::unordered_map<std::uint32_t, std::shared_ptr<WarpingMesh>> warp_of;
+	std::unordered_map<std::uint32_t, std::shared_ptr<RenderTexture>> target_of;
+	std::unordered_map<std::uint32_t, std::shared_ptr<BlendingMesh>> blend_of;
+	std::unordered_map<std::uint32_t, std::shared_ptr<Output>> output_of;
+	auto fail = [&filepath](const char *what) {
+		ofLogError("ProjectFile") << what << ": " << filepath;
+		return false;
+	};
+	// ids are unique over all kinds. 0 means none, and the last one would leave no id for the next new object
+	std::unordered_set<std::uint32_t> ids;
+	auto claim = [&ids](std::uint32_t id) {
+		return id != 0 && id != std::numeric_limits<std::uint32_t>::max() && ids.insert(id).second;
+	};
+
+	for(std::size_t i = 0; i < counts[TARGET]; ++i) {
+		auto *info = &target_table[i*4];
+		if(!claim(info[0])) {
+			return fail("invalid or duplicate id");
+		}
+		auto r = std::make_shared<RenderTexture>();
+		r->set(makeFbo(info));
+		target_of[info[0]] = r;
+		loaded.add(r, info[0]);
+	}
+	for(std::size_t i = 0; i < counts[OUTPUT]; ++i) {
+		auto *info = &output_table[i*4];
+		if(!claim(info[0])) {
+			return fail("invalid or duplicate id");
+		}
+		auto *rect = &output_rects[i*4];
+		auto o = std::make_shared<Output>();
+		o->set(makeFbo(info));
+		o->setRect({rect[0], rect[1], rect[2], rect[3]});
+		output_of[info[0]] = o;
+		loaded.add(o, info[0]);
+	}
+	for(std::size_t i = 0; i < counts[SOURCE]; ++i) {
+		auto *info = &source_table[i*5];
+		if(!claim(info[0])) {
+			return fail("invalid or duplicate id");
+		}
+		auto s = std::make_shared<Source>();
+		switch(info[1]) {
+			case SOURCE_IMAGE: {
+				if(info[3] > strings.size() || strings.size()-info[3] < info[4]) {
+					return fail("broken file path");
+				}
+				auto image = std::make_shared<ImageFile>();
+				image->load(std::string(strings.data()+info[3], info[4]));
+				s->set(image);
+			}	break;
+			case SOURCE_RENDER_TEXTURE: {
+				auto found = target_of.find(info[2]);
+				if(found == end(target_of)) {
+					return fail("source of a missing render texture");
+				}
+				s->set(found->second->get());
+			}	break;
+		}
+		source_of[info[0]] = s;
+		loaded.add(s, info[0]);
+	}
+	for(std::size_t i = 0; i < counts[WARP]; ++i) {
+		auto *info = &warp_table[i*4];
+		if(!claim(info[0])) {
+			return fail("invalid or duplicate id");
+		}
+		auto w = std::make_shared<WarpingMesh>();
+		w->texcoord_range_ = getQuad(&warp_ranges[i*8]);
+		if(info[1] != 0xffffffffu) {
+			std::size_t cols = std::size_t(info[1])+1, rows = std::size_t(info[2])+1, offset = info[3];
+			if(offset > num_points || num_points-offset < cols*rows) {
+				return fail("broken warp mesh");
+			}
+			auto mesh = std::make_shared<ofx::mapper::Mesh>();
+			mesh->init(glm::ivec2(info[1], info[2]), {0,0,1,1}, {0,0,1,1});
+			for(std::size_t r = 0; r < rows; ++r) {
+				for(std::size_t c = 0; c < cols; ++c) {
+					auto index = offset+r*cols+c;
+					auto point = mesh->getPoint(c, r);
+					memcpy(point.v, &vertices[index*3], sizeof(float)*3);
+					memcpy(point.t, &texcoords[index*2], sizeof(float)*2);
+				}
+			}
+			w->set(mesh);
+		}
+		warp_of[info[0]] = w;
+		loaded.add(w, info[0]);
+	}
+	for(std::size_t i = 0; i < counts[BLEND]; ++i) {
+		if(!claim(blend_ids[i])) {
+			return fail("invalid or duplicate id");
+		}
+		auto b = std::make_shared<BlendingMesh>();
+		auto *quads = &blend_quads[i*32];
+		b->vertex_outer_ = getQuad(quads);
+		b->vertex_inner_ = getQuad(quads+8);
+		b->vertex_frame_ = getQuad(quads+16);
+		b->texture_uv_for_frame_ = getQuad(quads+24);
+		blend_of[blend_ids[i]] = b;
+		loaded.add(b, blend_ids[i]);
+	}
+
+	auto bindAll = [&](int relation, auto &lhs, auto &rhs) {
+		auto &&pairs = bindings[relation];
+		for(std::size_t i = 0; i+1 < pairs.size(); i += 2) {
+			auto a = lhs.find(pairs[i]);
+			auto b = rhs.find(pairs[i+1]);
+			if(a == end(lhs) || b == end(rhs)) {
+				return false;
+			}
+			loaded.bind(a->second, b->second);
+		}
+		return true;
+	};
+	if(!bindAll(WARP_SOURCE, warp_of, source_of)
+	   || !bindAll(WARP_TARGET, warp_of, target_of)
+	   || !bindAll(BLEND_TARGET, blend_of, target_of)
+	   || !bindAll(BLEND_OUTPUT, blend_of, output_of)) {
+		return fail("binding of a missing node");
+	}
+	storage = std::move(loaded);
+	return true;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "ResourceStorage.h"
+#include <filesystem>
+
+namespace maaaaap {
+// binary save/load of a whole ResourceStorage: the nodes with their ids, the bindings,
+// control points of the warps and the quads of the blends.
+// every table is a flat little endian array, read in bulk out of a memory mapping of the file.
+bool saveProject(const ResourceStorage &storage, const std::filesystem::path &filepath);
+// storage is only replaced if the whole file could be read
+bool loadProject(const std::filesystem::path &filepath, ResourceStorage &storage);
+}
@@ -0,0 +1,207 @@
+#include "RenderGraph.h"
+#include "ofGraphics.h"
+#include "ofUtils.h"
+#include "ofLog.h"
+
+using namespace maaaaap;
+
+bool RenderGraph::needsCompile(const ResourceStorage &storage) const
+{
+	if(!is_compiled_ || compiled_version_ != storage.getVersion()) {
+		return true;
+	}
+	// another footage on a source may turn a render texture into an input of another
+	for(auto &&node : nodes_) {
+		for(auto &&in : node.inputs) {
+			if(in.source->getVersion() != in.source_version) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void RenderGraph::compile(ResourceStorage &storage)
+{
+	auto &targets = storage.getContainer<RenderTexture>();
+	std::vector<Node> nodes;
+	nodes.reserve(targets.size());
+	std::map<const Footage*, std::size_t> index_of_fbo;
+	for(auto &&r : targets) {
+		Node node;
+		node.target = r;
+		for(auto &&w : storage.getWarpsBoundTo(r)) {
+			auto s = storage.getSourceFor(w);
+			if(!s) {
+				continue;
+			}
+			node.inputs.push_back({w, s, s->getVersion()});
+			// only a run of warps on one source is merged; overlapping warps keep compositing in bound order
+			if(node.batches.empty() || node.batches.back().source != s) {
+				node.batches.emplace_back();
+				node.batches.back().source = s;
+			}
+			node.batches.back().warps.push_back(w);
+		}
+		if(auto fbo = r->get()) {
+			index_of_fbo[fbo.get()] = nodes.size();
+		}
+		nodes.push_back(std::move(node));
+	}
+
+	// kahn's algorithm over "node reads the fbo of another node"
+	std::vector<std::vector<std::size_t>> readers(nodes.size());
+	std::vector<std::size_t> num_deps(nodes.size(), 0);
+	for(std::size_t i = 0; i < nodes.size(); ++i) {
+		for(auto &&in : nodes[i].inputs) {
+			auto found = index_of_fbo.find(in.source->get().get());
+			if(found != end(index_of_fbo)) {
+				readers[found->second].push_back(i);
+				++num_deps[i];
+			}
+		}
+	}
+	std::vector<std::size_t> order;
+	order.reserve(nodes.size());
+	for(std::size_t i = 0; i < nodes.size(); ++i) {
+		if(num_deps[i] == 0) {
+			order.push_back(i);
+		}
+	}
+	for(std::size_t i = 0; i < order.size(); ++i) {
+		for(auto &&r : readers[order[i]]) {
+			if(--num_deps[r] == 0) {
+				order.push_back(r);
+			}
+		}
+	}
+	if(order.size() < nodes.size()) {
+		ofLogWarning("RenderGraph") << "render textures reading each other; drawing the cycle in no particular order";
+		for(std::size_t i = 0; i < nodes.size(); ++i) {
+			if(num_deps[i] > 0) {
+				order.push_back(i);
+			}
+		}
+	}
+	nodes_.clear();
+	nodes_.reserve(nodes.size());
+	for(auto &&i : order) {
+		nodes_.push_back(std::move(nodes[i]));
+	}
+
+	// forget targets that are gone so their fbos can be released
+	for(auto it = begin(keys_); it != end(keys_);) {
+		if(targets.find(it->first) == end(targets)) {
+			it = keys_.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	compiled_version_ = storage.getVersion();
+	is_compiled_ = true;
+}
+
+std::vector<std::size_t> RenderGraph::makeKey(const Node &node)
+{
+	std::vector<std::size_t> key;
+	key.reserve(node.inputs.size()*5);
+	for(auto &&in : node.inputs) {
+		auto footage = in.source->get();
+		key.push_back(reinterpret_cast<std::size_t>(in.warp.get()));
+		key.push_back(in.warp->getVersion());
+		key.push_back(reinterpret_cast<std::size_t>(in.source.get()));
+		key.push_back(reinterpret_cast<std::size_t>(footage.get()));
+		key.push_back(footage ? footage->getVersion() : 0);
+	}
+	return key;
+}
+
+void RenderGraph::updateBatch(Batch &batch)
+{
+	std::vector<std::size_t> key;
+	key.reserve(batch.warps.size()*2);
+	for(auto &&w : batch.warps) {
+		key.push_back(reinterpret_cast<std::size_t>(w.get()));
+		key.push_back(w->getVersion());
+	}
+	if(key == batch.key) {
+		return;
+	}
+	// positions, texcoords and indices are all a textured draw needs
+	ofMesh merged;
+	for(auto &&w : batch.warps) {
+		auto &&mesh = w->getMesh();
+		if(mesh.getMode() != OF_PRIMITIVE_TRIANGLES) {
+			ofLogWarning("RenderGraph") << "only triangle meshes can be batched; skipping a warp";
+			continue;
+		}
+		auto base = merged.getNumVertices();
+		merged.addVertices(mesh.getVertices());
+		if(mesh.getNumTexCoords() == mesh.getNumVertices()) {
+			merged.addTexCoords(mesh.getTexCoords());
+		}
+		else {
+			merged.getTexCoords().resize(merged.getNumVertices());
+		}
+		if(mesh.hasIndices()) {
+			for(auto &&i : mesh.getIndices()) {
+				merged.addIndex(base+i);
+			}
+		}
+		else {
+			for(std::size_t i = 0; i < mesh.getNumVertices(); ++i) {
+				merged.addIndex(base+i);
+			}
+		}
+	}
+	batch.vbo.setMesh(merged, GL_STATIC_DRAW);
+	batch.num_indices = merged.getNumIndices();
+	batch.key = std::move(key);
+}
+
+void RenderGraph::render(Node &node)
+{
+	node.target->begin();
+	ofClear(0);
+	for(auto &&batch : node.batches) {
+		if(!batch.source->get()) {
+			continue;
+		}
+		updateBatch(batch);
+		if(batch.num_indices == 0) {
+			continue;
+		}
+		auto tex = batch.source->getTexture();
+		tex.bind();
+		batch.vbo.drawElements(GL_TRIANGLES, batch.num_indices);
+		tex.unbind();
+	}
+	node.target->end();
+}
+
+void RenderGraph::update(ResourceStorage &storage)
+{
+	if(needsCompile(storage)) {
+		compile(storage);
+	}
+	stats_ = Stats();
+	stats_.nodes.reserve(nodes_.size());
+	for(auto &&node : nodes_) {
+		// keys are taken in order, so a target drawn just before bumps the footage version seen here
+		auto key = makeKey(node);
+		auto found = keys_.find(node.target);
+		if(found != end(keys_) && found->second == key) {
+			stats_.nodes.push_back({node.target, false, 0});
+			++stats_.num_skipped;
+			continue;
+		}
+		auto start = ofGetElapsedTimeMicros();
+		render(node);
+		auto micros = ofGetElapsedTimeMicros()-start;
+		keys_[node.target] = std::move(key);
+		stats_.nodes.push_back({node.target, true, micros});
+		++stats_.num_rendered;
+		stats_.micros += micros;
+	}
+}
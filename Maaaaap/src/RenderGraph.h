@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ResourceStorage.h"
+#include "ofVbo.h"
+#include <map>
+#include <cstdint>
+
+namespace maaaaap {
+// schedules drawing warps into render textures.
+// the bindings of the storage are compiled into a graph of render textures, ordered so that a texture
+// used as a source(through its fbo) is drawn before the ones sampling it. every frame each target
+// collects the versions of its warps and their sources, and is only drawn again if any of them changed.
+// consecutive warps of a target sharing a source are merged into one vbo, so a target takes one draw per run of a source.
+class RenderGraph
+{
+public:
+	struct NodeStats {
+		std::shared_ptr<RenderTexture> target;
+		bool is_rendered;
+		std::uint64_t micros;	// cpu time submitting the draws, 0 if skipped
+	};
+	struct Stats {
+		std::vector<NodeStats> nodes;	// in render order
+		std::size_t num_rendered=0, num_skipped=0;
+		std::uint64_t micros=0;
+	};
+	void update(ResourceStorage &storage);
+	// recompiles and draws everything on the next update, e.g. after reallocating fbos or loading another storage
+	void invalidate() { keys_.clear(); is_compiled_ = false; }
+	const Stats& getStats() const { return stats_; }
+private:
+	struct Input {
+		std::shared_ptr<WarpingMesh> warp;
+		std::shared_ptr<Source> source;
+		std::size_t source_version;
+	};
+	struct Batch {
+		std::shared_ptr<Source> source;
+		std::vector<std::shared_ptr<WarpingMesh>> warps;
+		std::vector<std::size_t> key;	// warps and their versions the vbo was built from
+		ofVbo vbo;
+		std::size_t num_indices=0;
+	};
+	struct Node {
+		std::shared_ptr<RenderTexture> target;
+		std::vector<Input> inputs;
+		std::vector<Batch> batches;
+	};
+	std::vector<Node> nodes_;	// in topological order
+	std::size_t compiled_version_=0;
+	bool is_compiled_=false;
+	// what the current content of each target was drawn from
+	std::map<std::shared_ptr<RenderTexture>, std::vector<std::size_t>> keys_;
+	Stats stats_;
+
+	bool needsCompile(const ResourceStorage &storage) const;
+	void compile(ResourceStorage &storage);
+	static std::vector<std::size_t> makeKey(const Node &node);
+	static void updateBatch(Batch &batch);
+	static void render(Node &node);
+};
+}
@@ -34,4 +34,10 @@ std::shared_ptr<Output> ResourceStorage::getOutputFor(std::shared_ptr<BlendingMe
 {
 	return getRelativeSingle<BlendingMesh, Output>(b);
 }
-
+void ResourceStorage::sweepExpired(std::size_t max_steps)
+{
+	sweep(ws_, max_steps);
+	sweep(wr_, max_steps);
+	sweep(br_, max_steps);
+	sweep(bo_, max_steps);
+}
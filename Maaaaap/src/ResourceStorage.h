@@ -2,6 +2,10 @@
 
 #include "Models.h"
 #include <map>
+#include <set>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
 
 namespace maaaaap {
 class ResourceStorage {
@@ -10,6 +14,10 @@ public:
 	template<typename T, typename U> void unbind(std::shared_ptr<T> t, std::shared_ptr<U> u);
 	template<typename T> void remove(std::shared_ptr<T> t);
 	template<typename T> void add(std::shared_ptr<T> t);
+	// with the id it had when saved. ids are unique over all kinds and never reused.
+	template<typename T> void add(std::shared_ptr<T> t, std::uint32_t id);
+	// 0 for objects not in the storage
+	template<typename T> std::uint32_t getId(const std::shared_ptr<T> &t) const;
 	template<typename T> std::set<std::shared_ptr<T>>& getContainer();
 	template<typename T> const std::set<std::shared_ptr<T>>& getContainer() const { return const_cast<ResourceStorage*>(this)->getContainer<T>(); }
 	
@@ -30,27 +38,51 @@ public:
 	const std::vector<std::shared_ptr<BlendingMesh>> getBlendsReferencing(std::shared_ptr<RenderTexture> r) const { return const_cast<ResourceStorage*>(this)->getBlendsReferencing(r); }
 	const std::vector<std::shared_ptr<BlendingMesh>> getBlendsBoundTo(std::shared_ptr<Output> o) const { return const_cast<ResourceStorage*>(this)->getBlendsBoundTo(o); }
 	const std::shared_ptr<Output> getOutputFor(std::shared_ptr<BlendingMesh> b) const { return const_cast<ResourceStorage*>(this)->getOutputFor(b); }
+	
+	// bumped by every change of the containers or the bindings
+	std::size_t getVersion() const { return version_; }
+	
+	// drops up to max_steps bindings of destroyed objects per relation. bind/unbind already do a little of it.
+	void sweepExpired(std::size_t max_steps);
 private:
+	static constexpr std::size_t SWEEP_STEPS_PER_CHANGE = 4;
+	std::size_t version_=0;
+	std::map<const void*, std::uint32_t> ids_;
+	std::uint32_t next_id_=1;
+	template<typename T> void insert(std::shared_ptr<T> t);
 	std::set<std::shared_ptr<Source>> s_;
 	std::set<std::shared_ptr<WarpingMesh>> w_;
 	std::set<std::shared_ptr<RenderTexture>> r_;
 	std::set<std::shared_ptr<BlendingMesh>> b_;
 	std::set<std::shared_ptr<Output>> o_;
 	
+	template<typename T>
+	using weak_set = std::set<std::weak_ptr<T>, std::owner_less<std::weak_ptr<T>>>;
 	template<typename T, typename U>
 	using weak_map = std::map<std::weak_ptr<T>, std::weak_ptr<U>, std::owner_less<std::weak_ptr<T>>>;
-	weak_map<WarpingMesh, Source> ws_;
-	weak_map<WarpingMesh, RenderTexture> wr_;
-	weak_map<BlendingMesh, RenderTexture> br_;
-	weak_map<BlendingMesh, Output> bo_;
+	// each T is bound to at most one U. reverse lists the Ts of each U so multi lookups only touch their result.
+	// entries of destroyed objects are swept a few at a time on every change, resuming from sweep_cursor.
+	template<typename T, typename U>
+	struct Relation {
+		weak_map<T,U> forward;
+		std::map<std::weak_ptr<U>, weak_set<T>, std::owner_less<std::weak_ptr<U>>> reverse;
+		std::weak_ptr<T> sweep_cursor;
+	};
+	Relation<WarpingMesh, Source> ws_;
+	Relation<WarpingMesh, RenderTexture> wr_;
+	Relation<BlendingMesh, RenderTexture> br_;
+	Relation<BlendingMesh, Output> bo_;
+	
+	template<typename T, typename U> Relation<T,U>& getRelation();
+	template<> Relation<WarpingMesh, Source>& getRelation<WarpingMesh, Source>() { return ws_; }
+	template<> Relation<WarpingMesh, RenderTexture>& getRelation<WarpingMesh, RenderTexture>() { return wr_; }
+	template<> Relation<BlendingMesh, RenderTexture>& getRelation<BlendingMesh, RenderTexture>() { return br_; }
+	template<> Relation<BlendingMesh, Output>& getRelation<BlendingMesh, Output>() { return bo_; }
 	
-	template<typename T, typename U> weak_map<T,U>& getMap();
-	template<> weak_map<WarpingMesh, Source>& getMap<WarpingMesh, Source>() { return ws_; }
-	template<> weak_map<WarpingMesh, RenderTexture>& getMap<WarpingMesh, RenderTexture>() { return wr_; }
-	template<> weak_map<BlendingMesh, RenderTexture>& getMap<BlendingMesh, RenderTexture>() { return br_; }
-	template<> weak_map<BlendingMesh, Output>& getMap<BlendingMesh, Output>() { return bo_; }
+	template<typename T, typename U> const Relation<T,U>& getRelation() const { return const_cast<ResourceStorage*>(this)->getRelation<T,U>(); }
 	
-	template<typename T, typename U> const weak_map<T,U>& getMap() const { return const_cast<ResourceStorage*>(this)->getMap<T,U>(); }
+	template<typename T, typename U> static void eraseReverse(Relation<T,U> &rel, const std::weak_ptr<T> &t, const std::weak_ptr<U> &u);
+	template<typename T, typename U> static void sweep(Relation<T,U> &rel, std::size_t max_steps);
 	
 	template<typename T, typename U> std::shared_ptr<U> getRelativeSingle(std::shared_ptr<T> t);
 	template<typename T, typename U> std::vector<std::shared_ptr<T>> getRelativeMulti(std::shared_ptr<U> u);
@@ -62,32 +94,99 @@ private:
 template<typename T, typename U>
 inline void ResourceStorage::bind(std::shared_ptr<T> t, std::shared_ptr<U> u)
 {
-	auto &m = getMap<T,U>();
-	auto result = m.insert(std::make_pair(t, u));
+	auto &rel = getRelation<T,U>();
+	auto result = rel.forward.insert(std::make_pair(t, u));
 	if(!result.second) {
+		eraseReverse(rel, std::weak_ptr<T>(t), result.first->second);
 		result.first->second = u;
 	}
-	getContainer<T>().insert(t);
-	getContainer<U>().insert(u);
+	rel.reverse[u].insert(t);
+	insert(t);
+	insert(u);
+	++version_;
+	sweep(rel, SWEEP_STEPS_PER_CHANGE);
 }
 template<typename T, typename U>
 inline void ResourceStorage::unbind(std::shared_ptr<T> t, std::shared_ptr<U> u)
 {
-	auto &m = getMap<T,U>();
-	auto found = m.find(t);
-	if(found != end(m) && found->second.lock() == u) {
-		m.erase(found);
+	auto &rel = getRelation<T,U>();
+	auto found = rel.forward.find(t);
+	if(found != end(rel.forward) && found->second.lock() == u) {
+		rel.forward.erase(found);
+		eraseReverse(rel, std::weak_ptr<T>(t), std::weak_ptr<U>(u));
+		++version_;
+	}
+	sweep(rel, SWEEP_STEPS_PER_CHANGE);
+}
+template<typename T, typename U>
+inline void ResourceStorage::eraseReverse(Relation<T,U> &rel, const std::weak_ptr<T> &t, const std::weak_ptr<U> &u)
+{
+	auto found = rel.reverse.find(u);
+	if(found == end(rel.reverse)) {
+		return;
+	}
+	found->second.erase(t);
+	if(found->second.empty()) {
+		rel.reverse.erase(found);
+	}
+}
+template<typename T, typename U>
+inline void ResourceStorage::sweep(Relation<T,U> &rel, std::size_t max_steps)
+{
+	auto &m = rel.forward;
+	// the cursor keeps its control block alive, so it still orders correctly after its object is gone.
+	// an empty one orders first and starts over from the beginning.
+	auto it = m.lower_bound(rel.sweep_cursor);
+	for(std::size_t i = 0; i < max_steps && it != end(m); ++i) {
+		if(it->first.expired() || it->second.expired()) {
+			eraseReverse(rel, it->first, it->second);
+			it = m.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	rel.sweep_cursor = it != end(m) ? it->first : std::weak_ptr<T>();
+}
+template<typename T>
+inline void ResourceStorage::insert(std::shared_ptr<T> t)
+{
+	if(getContainer<T>().insert(t).second) {
+		ids_.insert(std::make_pair(t.get(), next_id_++));
 	}
 }
 template<typename T>
 inline void ResourceStorage::add(std::shared_ptr<T> t)
 {
-	getContainer<T>().insert(t);
+	insert(t);
+	++version_;
+}
+template<typename T>
+inline void ResourceStorage::add(std::shared_ptr<T> t, std::uint32_t id)
+{
+	if(getContainer<T>().insert(t).second) {
+		ids_[t.get()] = id;
+		// saturates instead of wrapping to 0; loadProject doesn't hand out the last id
+		if(id >= next_id_) {
+			next_id_ = id < std::numeric_limits<std::uint32_t>::max() ? id+1 : id;
+		}
+	}
+	++version_;
+}
+template<typename T>
+inline std::uint32_t ResourceStorage::getId(const std::shared_ptr<T> &t) const
+{
+	auto found = ids_.find(t.get());
+	return found != end(ids_) ? found->second : 0;
 }
 template<typename T>
 inline void ResourceStorage::remove(std::shared_ptr<T> t)
 {
-	getContainer<T>().erase(t);
+	// removing what isn't there changes nothing, so caches keyed by the version stay valid
+	if(getContainer<T>().erase(t) > 0) {
+		ids_.erase(t.get());
+		++version_;
+	}
 }
 template<> inline std::set<std::shared_ptr<Source>>& ResourceStorage::getContainer() { return s_; }
 template<> inline std::set<std::shared_ptr<WarpingMesh>>& ResourceStorage::getContainer() { return w_; }
@@ -98,7 +197,7 @@ template<> inline std::set<std::shared_ptr<Output>>& ResourceStorage::getContain
 template<typename T, typename U>
 inline std::shared_ptr<U> ResourceStorage::getRelativeSingle(std::shared_ptr<T> t)
 {
-	auto &m = getMap<T,U>();
+	auto &m = getRelation<T,U>().forward;
 	auto found = m.find(t);
 	return found != end(m) ? found->second.lock() : nullptr;
 }
@@ -106,11 +205,25 @@ template<typename T, typename U>
 inline std::vector<std::shared_ptr<T>> ResourceStorage::getRelativeMulti(std::shared_ptr<U> u)
 {
 	std::vector<std::shared_ptr<T>> ret;
-	auto &m = getMap<T,U>();
-	for(auto &&p : m) {
-		if(p.second.lock() == u && !p.first.expired()) {
-			ret.push_back(p.first.lock());
+	auto &rel = getRelation<T,U>();
+	auto found = rel.reverse.find(u);
+	if(found == end(rel.reverse)) {
+		return ret;
+	}
+	auto &ts = found->second;
+	ret.reserve(ts.size());
+	for(auto it = begin(ts); it != end(ts);) {
+		if(auto t = it->lock()) {
+			ret.push_back(t);
+			++it;
 		}
+		else {
+			// the forward entry goes with the next sweep over it
+			it = ts.erase(it);
+		}
+	}
+	if(ts.empty()) {
+		rel.reverse.erase(found);
 	}
 	return ret;
 }
@@ -4,64 +4,103 @@ void MeshPicker::setMesh(std::shared_ptr<ofx::mapper::Mesh> mesh)
 {
 	mesh_ = mesh;
 	picker_.setSelectionMargin(10);
-	hover_.setMesh(mesh);
-	selection_.setMesh(mesh);
-	selectable_.setMesh(mesh);
+	resetSets();
 }
 
 void MeshPicker::setSelectable(std::initializer_list<std::pair<int,int>> selectables)
 {
-	selectable_.clearAll();
+	selectable_points_.clear();
 	for(auto &&s : selectables) {
-		selectable_.selectPoint(s.first, s.second);
+		selectable_points_.emplace_back(s.first, s.second);
+	}
+	selectable_.clearAll();
+	for(auto &&s : selectable_points_) {
+		selectable_.set(s.x, s.y);
 	}
 }
 
-void MeshPicker::onPointHover(const ofxEditorFrame::PointHoverArg &arg)
+void MeshPicker::fitToMesh()
 {
-	auto picked = picker_.pickPoints(*mesh_, arg.pos);
-	ofx::mapper::Selector selected;
-	selected.resize(hover_.numCols(), hover_.numRows());
-	selected.clearAll();
-	for(auto &&p : picked) {
-		selected.selectPoint(p.index.x, p.index.y);
+	if(hover_.numCols() != mesh_->getNumCols()+1 || hover_.numRows() != mesh_->getNumRows()+1) {
+		resetSets();
 	}
-	hover_ = makeAnd(selectable_, selected);
+}
+
+void MeshPicker::resetSets()
+{
+	int cols = mesh_->getNumCols()+1, rows = mesh_->getNumRows()+1;
+	for(auto set : {&hover_, &selection_, &selectable_, &picked_}) {
+		set->resize(cols, rows);
+	}
+	for(auto &&s : selectable_points_) {
+		selectable_.set(s.x, s.y);
+	}
+	is_hover_dirty_ = is_selection_dirty_ = true;
+}
+
+void MeshPicker::beginPick()
+{
+	fitToMesh();
+	picked_.clearAll();
+}
+
+void MeshPicker::commitHover()
+{
+	picked_ &= selectable_;
+	if(picked_ != hover_) {
+		std::swap(hover_, picked_);
+		is_hover_dirty_ = true;
+	}
+}
+
+void MeshPicker::onPointHover(const ofxEditorFrame::PointHoverArg &arg)
+{
+	fitToMesh();
+	picker_.pickPoints(*mesh_, arg.pos, picked_);
+	commitHover();
 }
 void MeshPicker::onPointSelection(const ofxEditorFrame::PointSelectionArg &arg)
 {
 	if(!arg.finished) {
 		return;
 	}
-	auto picked = picker_.pickPoints(*mesh_, arg.pos);
-	ofx::mapper::Selector selected;
-	selected.resize(selection_.numCols(), selection_.numRows());
-	selected.clearAll();
-	for(auto &&p : picked) {
-		selected.selectPoint(p.index.x, p.index.y);
-	}
-	selected = makeAnd(selectable_, selected);
+	fitToMesh();
+	picker_.pickPoints(*mesh_, arg.pos, picked_);
+	commitSelection();
+}
+void MeshPicker::commitSelection()
+{
+	picked_ &= selectable_;
 	switch(mode_) {
 		case REPLACE:
-			selection_ = selected;
+			std::swap(selection_, picked_);
 			break;
 		case ADD:
-			selection_ = makeOr(selection_, selected);
+			selection_ |= picked_;
 			break;
 		case TOGGLE:
-			selection_ = makeXor(selection_, selected);
+			selection_ ^= picked_;
 			break;
 	}
+	is_selection_dirty_ = true;
 }
 void MeshPicker::onRectSelection(const ofxEditorFrame::RectSelectionArg &arg)
 {
 }
 
-std::vector<glm::ivec2> MeshPicker::getHover()
+IndexSpan MeshPicker::getHover()
 {
-	return hover_.getSelectedIndices();
+	if(is_hover_dirty_) {
+		hover_.getIndices(hover_indices_);
+		is_hover_dirty_ = false;
+	}
+	return {hover_indices_.data(), hover_indices_.data()+hover_indices_.size()};
 }
-std::vector<glm::ivec2> MeshPicker::getSelected()
+IndexSpan MeshPicker::getSelected()
 {
-	return selection_.getSelectedIndices();
+	if(is_selection_dirty_) {
+		selection_.getIndices(selection_indices_);
+		is_selection_dirty_ = false;
+	}
+	return {selection_indices_.data(), selection_indices_.data()+selection_indices_.size()};
 }
@@ -2,8 +2,9 @@
 
 #include "ofxEditorFrame.h"
 #include "ofxMapperMesh.h"
-#include "ofxMapperSelector.h"
+#include "PointSet.h"
 #include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
 
 class Pick
 {
@@ -12,6 +13,13 @@ public:
 		glm::ivec2 index;
 	};
 	virtual std::vector<Point> pickPoints(const ofx::mapper::Mesh &mesh, const glm::vec2 &pos){ return {}; }
+	// same as above, into a set sized to the mesh
+	virtual void pickPoints(const ofx::mapper::Mesh &mesh, const glm::vec2 &pos, PointSet &dst) {
+		dst.clearAll();
+		for(auto &&p : pickPoints(mesh, pos)) {
+			dst.set(p.index.x, p.index.y);
+		}
+	}
 };
 
 class PointPick : public Pick
@@ -24,6 +32,19 @@ public:
 		}
 		return ret;
 	}
+	// walks the points straight into dst, so a hover doesn't allocate
+	void pickPoints(const ofx::mapper::Mesh &mesh, const glm::vec2 &pos, PointSet &dst) override {
+		dst.clearAll();
+		const float margin2 = margin_*margin_;
+		for(int r = 0; r <= mesh.getNumRows(); ++r) {
+			for(int c = 0; c <= mesh.getNumCols(); ++c) {
+				glm::vec2 d = glm::vec2(*mesh.getPoint(c, r).v)-pos;
+				if(glm::dot(d,d) <= margin2) {
+					dst.set(c, r);
+				}
+			}
+		}
+	}
 	void setSelectionMargin(float margin) { margin_ = margin; }
 private:
 	float margin_;
@@ -46,12 +67,27 @@ public:
 	void onPointSelection(const ofxEditorFrame::PointSelectionArg &arg);
 	void onRectSelection(const ofxEditorFrame::RectSelectionArg &arg);
 	
-	std::vector<glm::ivec2> getHover();
-	std::vector<glm::ivec2> getSelected();
+	// for owners picking on their own(e.g. through a PointGrid shared by several meshes):
+	// start, mark the picked points, then commit them the way the events above would
+	void beginPick();
+	void pick(const glm::ivec2 &index) { picked_.set(index.x, index.y); }
+	void commitHover();
+	void commitSelection();
+	
+	// valid until the next event
+	IndexSpan getHover();
+	IndexSpan getSelected();
 	
 private:
 	std::shared_ptr<ofx::mapper::Mesh> mesh_;
 	PointPick picker_;
-	Mode mode_;
-	ofx::mapper::Selector hover_, selection_, selectable_;
+	Mode mode_=REPLACE;
+	std::vector<glm::ivec2> selectable_points_;
+	PointSet hover_, selection_, selectable_, picked_;
+	std::vector<glm::ivec2> hover_indices_, selection_indices_;
+	bool is_hover_dirty_=true, is_selection_dirty_=true;
+	
+	// resizes the sets if the mesh was divided since
+	void fitToMesh();
+	void resetSets();
 };
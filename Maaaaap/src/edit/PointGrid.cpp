@@ -0,0 +1,70 @@
+#include "PointGrid.h"
+#include <algorithm>
+#include <climits>
+
+void PointGrid::setCellSize(float size)
+{
+	cell_size_ = std::max(size, 1e-3f);
+	clear();
+}
+
+void PointGrid::clear()
+{
+	cells_.clear();
+	where_.clear();
+}
+
+void PointGrid::insert(Owner owner, const glm::ivec2 &index, const glm::vec2 &pos)
+{
+	auto cell = key(cellOf(pos));
+	auto result = where_.insert({{owner, {index.x, index.y}}, cell});
+	if(!result.second) {
+		eraseFromCell(result.first->second, owner, index);
+		result.first->second = cell;
+	}
+	cells_[cell].push_back({owner, index, pos});
+}
+
+void PointGrid::move(Owner owner, const glm::ivec2 &index, const glm::vec2 &pos)
+{
+	auto found = where_.find({owner, {index.x, index.y}});
+	if(found == end(where_)) {
+		return;
+	}
+	auto cell = key(cellOf(pos));
+	if(cell == found->second) {
+		for(auto &&e : cells_[cell]) {
+			if(e.owner == owner && e.index == index) {
+				e.pos = pos;
+			}
+		}
+		return;
+	}
+	eraseFromCell(found->second, owner, index);
+	found->second = cell;
+	cells_[cell].push_back({owner, index, pos});
+}
+
+void PointGrid::erase(Owner owner)
+{
+	auto it = where_.lower_bound({owner, {INT_MIN, INT_MIN}});
+	while(it != end(where_) && it->first.first == owner) {
+		eraseFromCell(it->second, owner, {it->first.second.first, it->first.second.second});
+		it = where_.erase(it);
+	}
+}
+
+void PointGrid::eraseFromCell(std::uint64_t cell, Owner owner, const glm::ivec2 &index)
+{
+	auto found = cells_.find(cell);
+	if(found == end(cells_)) {
+		return;
+	}
+	auto &entries = found->second;
+	entries.erase(std::remove_if(begin(entries), end(entries), [&](const Entry &e) {
+		return e.owner == owner && e.index == index;
+	}), end(entries));
+	if(entries.empty()) {
+		cells_.erase(found);
+	}
+}
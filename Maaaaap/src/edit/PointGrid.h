@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
+#include <unordered_map>
+#include <map>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+// buckets points of several meshes into square cells.
+// looking up the points around a position only visits the cells touching it,
+// so it costs the same however many meshes there are.
+class PointGrid
+{
+public:
+	using Owner = std::size_t;
+	struct Entry {
+		Owner owner;
+		glm::ivec2 index;
+		glm::vec2 pos;
+	};
+	// best about the pick margin, so a lookup touches at most 3x3 cells. clears.
+	void setCellSize(float size);
+	void clear();
+	void insert(Owner owner, const glm::ivec2 &index, const glm::vec2 &pos);
+	void move(Owner owner, const glm::ivec2 &index, const glm::vec2 &pos);
+	void erase(Owner owner);
+	std::size_t size() const { return where_.size(); }
+
+	// calls func(const Entry&) for every point within margin of pos
+	template<typename Func>
+	void query(const glm::vec2 &pos, float margin, Func &&func) const {
+		auto c0 = cellOf(pos-glm::vec2(margin)), c1 = cellOf(pos+glm::vec2(margin));
+		float margin2 = margin*margin;
+		for(int y = c0.y; y <= c1.y; ++y) {
+			for(int x = c0.x; x <= c1.x; ++x) {
+				auto found = cells_.find(key({x,y}));
+				if(found == end(cells_)) {
+					continue;
+				}
+				for(auto &&e : found->second) {
+					glm::vec2 d = e.pos-pos;
+					if(glm::dot(d,d) <= margin2) {
+						func(e);
+					}
+				}
+			}
+		}
+	}
+private:
+	float cell_size_=10;
+	std::unordered_map<std::uint64_t, std::vector<Entry>> cells_;
+	// the cell each point is in, to find it again on move and erase
+	std::map<std::pair<Owner, std::pair<int,int>>, std::uint64_t> where_;
+
+	glm::ivec2 cellOf(const glm::vec2 &pos) const {
+		return {(int)std::floor(pos.x/cell_size_), (int)std::floor(pos.y/cell_size_)};
+	}
+	static std::uint64_t key(const glm::ivec2 &cell) {
+		return (std::uint64_t)(std::uint32_t)cell.x << 32 | (std::uint32_t)cell.y;
+	}
+	void eraseFromCell(std::uint64_t cell, Owner owner, const glm::ivec2 &index);
+};
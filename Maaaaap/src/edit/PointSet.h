@@ -0,0 +1,105 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// points of a mesh grid as packed bits, row major.
+// combining and counting work a word at a time, and nothing allocates once sized.
+class PointSet
+{
+public:
+	void resize(int cols, int rows) {
+		cols_ = cols;
+		rows_ = rows;
+		bits_.assign((cols*rows+63)/64, 0);
+	}
+	int numCols() const { return cols_; }
+	int numRows() const { return rows_; }
+	void clearAll() { std::fill(begin(bits_), end(bits_), 0); }
+	void set(int col, int row, bool value=true) {
+		if(!isInside(col, row)) {
+			return;
+		}
+		std::size_t i = row*cols_+col;
+		if(value) bits_[i/64] |= bit(i);
+		else bits_[i/64] &= ~bit(i);
+	}
+	bool test(int col, int row) const {
+		if(!isInside(col, row)) {
+			return false;
+		}
+		std::size_t i = row*cols_+col;
+		return (bits_[i/64] & bit(i)) != 0;
+	}
+	std::size_t count() const {
+		std::size_t ret = 0;
+		for(auto &&w : bits_) {
+			ret += popcount(w);
+		}
+		return ret;
+	}
+	bool any() const { return std::any_of(begin(bits_), end(bits_), [](std::uint64_t w) { return w != 0; }); }
+
+	// both sides are expected to be the same size; extra words of the larger one are left as they are
+	PointSet& operator&=(const PointSet &rhs) { return combine(rhs, [](std::uint64_t a, std::uint64_t b) { return a&b; }); }
+	PointSet& operator|=(const PointSet &rhs) { return combine(rhs, [](std::uint64_t a, std::uint64_t b) { return a|b; }); }
+	PointSet& operator^=(const PointSet &rhs) { return combine(rhs, [](std::uint64_t a, std::uint64_t b) { return a^b; }); }
+	bool operator==(const PointSet &rhs) const { return cols_ == rhs.cols_ && rows_ == rhs.rows_ && bits_ == rhs.bits_; }
+	bool operator!=(const PointSet &rhs) const { return !(*this == rhs); }
+
+	// replaces the content of dst, reusing its capacity
+	void getIndices(std::vector<glm::ivec2> &dst) const {
+		dst.clear();
+		for(std::size_t w = 0; w < bits_.size(); ++w) {
+			for(std::uint64_t bits = bits_[w]; bits != 0; bits &= bits-1) {
+				std::size_t i = w*64 + countTrailingZeros(bits);
+				dst.emplace_back((int)(i%cols_), (int)(i/cols_));
+			}
+		}
+	}
+private:
+	int cols_=0, rows_=0;
+	std::vector<std::uint64_t> bits_;
+
+	bool isInside(int col, int row) const { return 0 <= col && col < cols_ && 0 <= row && row < rows_; }
+	static std::uint64_t bit(std::size_t i) { return std::uint64_t(1) << (i%64); }
+	template<typename Op>
+	PointSet& combine(const PointSet &rhs, Op op) {
+		std::size_t n = std::min(bits_.size(), rhs.bits_.size());
+		for(std::size_t i = 0; i < n; ++i) {
+			bits_[i] = op(bits_[i], rhs.bits_[i]);
+		}
+		return *this;
+	}
+	static int popcount(std::uint64_t v) {
+#if defined(_MSC_VER)
+		return (int)__popcnt64(v);
+#else
+		return __builtin_popcountll(v);
+#endif
+	}
+	static int countTrailingZeros(std::uint64_t v) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, v);
+		return (int)index;
+#else
+		return __builtin_ctzll(v);
+#endif
+	}
+};
+
+// a view of indices owned by someone else, valid until their next change
+struct IndexSpan {
+	const glm::ivec2 *first=nullptr, *last=nullptr;
+	const glm::ivec2* begin() const { return first; }
+	const glm::ivec2* end() const { return last; }
+	std::size_t size() const { return last-first; }
+	bool empty() const { return first == last; }
+	const glm::ivec2& operator[](std::size_t i) const { return first[i]; }
+};
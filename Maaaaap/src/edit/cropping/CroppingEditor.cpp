@@ -1,4 +1,5 @@
 #include "CroppingEditor.h"
+#include <algorithm>
 
 namespace {
 
@@ -7,13 +8,22 @@ CroppingEditor::FrameID NEXT_ID() {
 	return identifier++;
 }
 
+// corners of the outer and inner quads
+const std::initializer_list<std::pair<int,int>> SELECTABLE_POINTS{{0,0},{3,0},{1,1},{2,1},{1,2},{2,2},{0,3},{3,3}};
+
 }
 
+CroppingEditor::CroppingEditor()
+{
+	grid_.setCellSize(margin_);
+	ofAddListener(on_point_hover_, this, &CroppingEditor::onPointHover);
+	ofAddListener(on_point_selection_, this, &CroppingEditor::onPointSelection);
+}
 CroppingEditor::~CroppingEditor()
 {
-	while(!frame_.empty()) {
-		removeFrame(frame_.begin()->first);
-	}
+	clear();
+	ofRemoveListener(on_point_hover_, this, &CroppingEditor::onPointHover);
+	ofRemoveListener(on_point_selection_, this, &CroppingEditor::onPointSelection);
 }
 CroppingEditor::FrameID CroppingEditor::addFrame(const ofRectangle &rect, glm::vec2 h_range, glm::vec2 v_range, const geom::Quad &uv)
 {
@@ -26,12 +36,11 @@ CroppingEditor::FrameID CroppingEditor::addFrame(const ofRectangle &rect, glm::v
 	points->divideCol(0, {h_range[0], h_range[1]});
 	frame->points = points;
 	frame->picker.setMesh(points);
-	frame->picker.setSelectable({{0,0},{3,0},{1,1},{2,1},{1,2},{2,2},{0,3},{3,3}});
-	ofAddListener(on_point_hover_, &frame->picker, &MeshPicker::onPointHover);
-	ofAddListener(on_point_selection_, &frame->picker, &MeshPicker::onPointSelection);
+	frame->picker.setSelectable(SELECTABLE_POINTS);
 	ofAddListener(on_rect_selection_, &frame->picker, &MeshPicker::onRectSelection);
 	auto identifier = NEXT_ID();
 	frame_.insert(std::make_pair(identifier, frame));
+	insertPoints(identifier, *frame);
 	return identifier;
 }
 void CroppingEditor::removeFrame(FrameID identifier)
@@ -41,36 +50,154 @@ void CroppingEditor::removeFrame(FrameID identifier)
 		return;
 	}
 	auto &frame = found->second;
-	ofRemoveListener(on_point_hover_, &frame->picker, &MeshPicker::onPointHover);
-	ofRemoveListener(on_point_selection_, &frame->picker, &MeshPicker::onPointSelection);
 	ofRemoveListener(on_rect_selection_, &frame->picker, &MeshPicker::onRectSelection);
 	frame_.erase(found);
+	grid_.erase(identifier);
+	auto erase = [identifier](std::vector<FrameID> &ids) {
+		ids.erase(std::remove(begin(ids), end(ids), identifier), end(ids));
+	};
+	erase(hovered_);
+	erase(selected_);
+	tracked_.erase(std::remove_if(begin(tracked_), end(tracked_), [identifier](const Tracked &t) { return t.frame == identifier; }), end(tracked_));
 }
 void CroppingEditor::clear()
 {
-	frame_.clear();
+	while(!frame_.empty()) {
+		removeFrame(frame_.begin()->first);
+	}
+}
+
+void CroppingEditor::setSelectionMargin(float margin)
+{
+	margin_ = margin;
+	grid_.setCellSize(margin);
+	invalidatePoints();
 }
-ofMesh CroppingEditor::getResult() const
+void CroppingEditor::invalidatePoints()
 {
-	ofMesh ret;
+	grid_.clear();
 	for(auto &&f : frame_) {
-		ret.append(getResult(f.first));
+		insertPoints(f.first, *f.second);
 	}
-	return ret;
+	trackSelection();
+}
+void CroppingEditor::insertPoints(FrameID identifier, const Frame &frame)
+{
+	for(auto &&p : SELECTABLE_POINTS) {
+		grid_.insert(identifier, {p.first, p.second}, *frame.points->getPoint(p.first, p.second).v);
+	}
+}
+void CroppingEditor::followSelection()
+{
+	for(auto &&t : tracked_) {
+		auto &&frame = frame_.at(t.frame);
+		glm::vec2 pos = *frame->points->getPoint(t.index.x, t.index.y).v;
+		if(pos != t.pos) {
+			grid_.move(t.frame, t.index, pos);
+			t.pos = pos;
+		}
+	}
+}
+void CroppingEditor::trackSelection()
+{
+	tracked_.clear();
+	for(auto &&identifier : selected_) {
+		auto &&frame = frame_.at(identifier);
+		for(auto &&index : frame->picker.getSelected()) {
+			tracked_.push_back({identifier, index, *frame->points->getPoint(index.x, index.y).v});
+		}
+	}
+}
+
+template<typename Commit, typename IsActive>
+void CroppingEditor::pick(const glm::vec2 &pos, std::vector<FrameID> &active, Commit &&commit, IsActive &&is_active)
+{
+	// points may have been dragged since the last event
+	followSelection();
+	hit_.clear();
+	grid_.query(pos, margin_, [this](const PointGrid::Entry &e) {
+		if(std::find(begin(hit_), end(hit_), e.owner) == end(hit_)) {
+			hit_.push_back(e.owner);
+			frame_.at(e.owner)->picker.beginPick();
+		}
+		frame_.at(e.owner)->picker.pick(e.index);
+	});
+	// frames that had something but weren't hit now commit an empty pick
+	touched_ = hit_;
+	for(auto &&identifier : active) {
+		if(std::find(begin(hit_), end(hit_), identifier) == end(hit_)) {
+			frame_.at(identifier)->picker.beginPick();
+			touched_.push_back(identifier);
+		}
+	}
+	active.clear();
+	for(auto &&identifier : touched_) {
+		auto &picker = frame_.at(identifier)->picker;
+		commit(picker);
+		if(is_active(picker)) {
+			active.push_back(identifier);
+		}
+	}
+}
+
+void CroppingEditor::onPointHover(const PointHoverArg &arg)
+{
+	pick(arg.pos, hovered_,
+		 [](MeshPicker &picker) { picker.commitHover(); },
+		 [](MeshPicker &picker) { return !picker.getHover().empty(); });
+}
+void CroppingEditor::onPointSelection(const PointSelectionArg &arg)
+{
+	if(!arg.finished) {
+		return;
+	}
+	pick(arg.pos, selected_,
+		 [](MeshPicker &picker) { picker.commitSelection(); },
+		 [](MeshPicker &picker) { return !picker.getSelected().empty(); });
+	trackSelection();
 }
-ofMesh CroppingEditor::getResult(FrameID identifier) const
+const ofMesh& CroppingEditor::getResult() const
 {
+	bool is_changed = result_key_.size() != frame_.size();
+	std::size_t i = 0;
+	for(auto &&f : frame_) {
+		updateMesh(*f.second);
+		is_changed |= !is_changed && result_key_[i] != std::make_pair(f.first, f.second->version);
+		++i;
+	}
+	if(is_changed) {
+		// clear keeps the capacity, so only growing reallocates
+		result_key_.clear();
+		result_.clear();
+		for(auto &&f : frame_) {
+			result_key_.emplace_back(f.first, f.second->version);
+			result_.append(f.second->mesh);
+		}
+	}
+	return result_;
+}
+const ofMesh& CroppingEditor::getResult(FrameID identifier) const
+{
+	static const ofMesh empty;
 	auto found = frame_.find(identifier);
-	if(found == end(frame_)) {
-		return {};
+	return found == end(frame_) ? empty : updateMesh(*found->second);
+}
+const ofMesh& CroppingEditor::updateMesh(const Frame &frame)
+{
+	auto &&points = frame.points;
+	geom::Quad outer{*points->getPoint(0, 0).v, *points->getPoint(3, 0).v, *points->getPoint(0, 3).v, *points->getPoint(3, 3).v};
+	geom::Quad inner{*points->getPoint(1, 1).v, *points->getPoint(2, 1).v, *points->getPoint(1, 2).v, *points->getPoint(2, 2).v};
+	if(!frame.is_cached || outer != frame.seen[0] || inner != frame.seen[1]
+	   || frame.vertex_frame != frame.seen[2] || frame.texture_uv_for_frame != frame.seen[3]) {
+		frame.seen[0] = outer;
+		frame.seen[1] = inner;
+		frame.seen[2] = frame.vertex_frame;
+		frame.seen[3] = frame.texture_uv_for_frame;
+		frame.mesh = ofxBlendScreen::createMesh(outer, inner, frame.vertex_frame, frame.texture_uv_for_frame);
+		++frame.version;
+		frame.is_cached = true;
 	}
-	auto &&frame = found->second;
-	auto &&points = frame->points;
-	return ofxBlendScreen::createMesh(
-	  {*points->getPoint(0, 0).v, *points->getPoint(3, 0).v, *points->getPoint(0, 3).v, *points->getPoint(3, 3).v},
-	  {*points->getPoint(1, 1).v, *points->getPoint(2, 1).v, *points->getPoint(1, 2).v, *points->getPoint(2, 2).v},
-	  frame->vertex_frame, frame->texture_uv_for_frame
-	);
+	return frame.mesh;
 }
 
 geom::Quad* CroppingEditor::getUVQuad(FrameID identifier)
@@ -82,10 +209,10 @@ geom::Quad* CroppingEditor::getUVQuad(FrameID identifier)
 std::vector<ofx::mapper::Mesh::PointRef> CroppingEditor::getHover()
 {
 	std::vector<ofx::mapper::Mesh::PointRef> ret;
-	for(auto &&f : frame_) {
-		auto &&picked = f.second->picker.getHover();
-		for(auto &&p : picked) {
-			ret.push_back(f.second->points->getPoint(p.x, p.y));
+	for(auto &&identifier : hovered_) {
+		auto &&frame = frame_.at(identifier);
+		for(auto &&p : frame->picker.getHover()) {
+			ret.push_back(frame->points->getPoint(p.x, p.y));
 		}
 	}
 	return ret;
@@ -93,10 +220,10 @@ std::vector<ofx::mapper::Mesh::PointRef> CroppingEditor::getHover()
 std::vector<ofx::mapper::Mesh::PointRef> CroppingEditor::getSelected()
 {
 	std::vector<ofx::mapper::Mesh::PointRef> ret;
-	for(auto &&f : frame_) {
-		auto &&picked = f.second->picker.getSelected();
-		for(auto &&p : picked) {
-			ret.push_back(f.second->points->getPoint(p.x, p.y));
+	for(auto &&identifier : selected_) {
+		auto &&frame = frame_.at(identifier);
+		for(auto &&p : frame->picker.getSelected()) {
+			ret.push_back(frame->points->getPoint(p.x, p.y));
 		}
 	}
 	return ret;
@@ -104,10 +231,10 @@ std::vector<ofx::mapper::Mesh::PointRef> CroppingEditor::getSelected()
 std::vector<ofx::mapper::Mesh::PointRef> CroppingEditor::getHover() const
 {
 	std::vector<ofx::mapper::Mesh::PointRef> ret;
-	for(auto &&f : frame_) {
-		auto &&picked = f.second->picker.getHover();
-		for(auto &&p : picked) {
-			ret.push_back(f.second->points->getPoint(p.x, p.y));
+	for(auto &&identifier : hovered_) {
+		auto &&frame = frame_.at(identifier);
+		for(auto &&p : frame->picker.getHover()) {
+			ret.push_back(frame->points->getPoint(p.x, p.y));
 		}
 	}
 	return ret;
@@ -115,10 +242,10 @@ std::vector<ofx::mapper::Mesh::PointRef> CroppingEditor::getHover() const
 std::vector<ofx::mapper::Mesh::PointRef> CroppingEditor::getSelected() const
 {
 	std::vector<ofx::mapper::Mesh::PointRef> ret;
-	for(auto &&f : frame_) {
-		auto &&picked = f.second->picker.getSelected();
-		for(auto &&p : picked) {
-			ret.push_back(f.second->points->getPoint(p.x, p.y));
+	for(auto &&identifier : selected_) {
+		auto &&frame = frame_.at(identifier);
+		for(auto &&p : frame->picker.getSelected()) {
+			ret.push_back(frame->points->getPoint(p.x, p.y));
 		}
 	}
 	return ret;
@@ -5,20 +5,28 @@
 #include "ofxMapperMesh.h"
 #include <glm/vec2.hpp>
 #include "Pick.h"
+#include "PointGrid.h"
 #include "Quad.h"
 
 class CroppingEditor : public ofxEditorFrame
 {
 public:
+	CroppingEditor();
 	virtual ~CroppingEditor();
 	using FrameID = std::size_t;
 	FrameID addFrame(const ofRectangle &rect, glm::vec2 h_range={0,1}, glm::vec2 v_range={0,1}, const geom::Quad &uv={1,1});
 	void removeFrame(FrameID identifier);
 	void clear();
-	ofMesh getResult() const;
-	ofMesh getResult(FrameID identifier) const;
+	// both are cached and only rebuilt when control points or quads moved
+	const ofMesh& getResult() const;
+	const ofMesh& getResult(FrameID identifier) const;
 	geom::Quad* getUVQuad(FrameID identifier);
 	
+	// in the editor's coordinates
+	void setSelectionMargin(float margin);
+	// call after moving points other than the selected ones(dividing, loading). moves of selected points are followed.
+	void invalidatePoints();
+	
 	std::vector<ofx::mapper::Mesh::PointRef> getHover();
 	std::vector<ofx::mapper::Mesh::PointRef> getSelected();
 	std::vector<ofx::mapper::Mesh::PointRef> getHover() const;
@@ -30,6 +38,37 @@ private:
 		geom::Quad texture_uv_for_frame;
 		std::shared_ptr<ofx::mapper::Mesh> points;
 		MeshPicker picker;
+		// outer, inner, frame and uv quads the mesh was made of
+		mutable geom::Quad seen[4];
+		mutable ofMesh mesh;
+		mutable std::size_t version=0;
+		mutable bool is_cached=false;
 	};
 	std::unordered_map<FrameID, std::shared_ptr<Frame>> frame_;
+	
+	// selectable points of all frames, so picking doesn't go through every frame
+	PointGrid grid_;
+	float margin_=10;
+	// frames having any hovered/selected points, the only ones besides the picked that need updating
+	std::vector<FrameID> hovered_, selected_;
+	// selected points where the grid has them
+	struct Tracked {
+		FrameID frame;
+		glm::ivec2 index;
+		glm::vec2 pos;
+	};
+	std::vector<Tracked> tracked_;
+	std::vector<FrameID> hit_, touched_;
+	void onPointHover(const PointHoverArg &arg);
+	void onPointSelection(const PointSelectionArg &arg);
+	void insertPoints(FrameID identifier, const Frame &frame);
+	void followSelection();
+	void trackSelection();
+	template<typename Commit, typename IsActive>
+	void pick(const glm::vec2 &pos, std::vector<FrameID> &active, Commit &&commit, IsActive &&is_active);
+	
+	// frames and their versions result_ was appended from
+	mutable std::vector<std::pair<FrameID, std::size_t>> result_key_;
+	mutable ofMesh result_;
+	static const ofMesh& updateMesh(const Frame &frame);
 };
@@ -153,6 +153,7 @@ void WarpingMeshInspector::EditMesh(std::shared_ptr<WarpingMesh> mesh, ResourceS
 		auto mesh = arg.mesh;
 		auto source = storage.getSourceFor(mesh);
 		auto target = storage.getRenderTextureIncluding(mesh);
+		if(!target || !target->get() || !source) return;
 		auto target_tex = target->get()->getTexture();
 		auto source_tex = source->getTexture();
 		auto &frame = self.frame_;
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+#include "ofLog.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::filesystem::path &filepath)
+{
+	close();
+#ifdef TARGET_WIN32
+	HANDLE file = CreateFileW(filepath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(file == INVALID_HANDLE_VALUE) {
+		ofLogError("MappedFile") << "failed to open: " << filepath;
+		return false;
+	}
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		ofLogError("MappedFile") << "failed to get size: " << filepath;
+		return false;
+	}
+	file_ = file;
+	size_ = static_cast<std::size_t>(size.QuadPart);
+	is_open_ = true;
+	if(size_ == 0) {
+		return true;
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if(!view) {
+		if(mapping) CloseHandle(mapping);
+		ofLogError("MappedFile") << "failed to map: " << filepath;
+		close();
+		return false;
+	}
+	mapping_ = mapping;
+	data_ = static_cast<const char*>(view);
+#else
+	int fd = ::open(filepath.c_str(), O_RDONLY);
+	if(fd < 0) {
+		ofLogError("MappedFile") << "failed to open: " << filepath;
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0) {
+		::close(fd);
+		ofLogError("MappedFile") << "failed to get size: " << filepath;
+		return false;
+	}
+	size_ = static_cast<std::size_t>(st.st_size);
+	is_open_ = true;
+	if(size_ == 0) {
+		::close(fd);
+		return true;
+	}
+	void *view = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+	if(view == MAP_FAILED) {
+		ofLogError("MappedFile") << "failed to map: " << filepath;
+		size_ = 0;
+		is_open_ = false;
+		return false;
+	}
+	data_ = static_cast<const char*>(view);
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef TARGET_WIN32
+	if(data_) UnmapViewOfFile(data_);
+	if(mapping_) CloseHandle(mapping_);
+	if(file_) CloseHandle(file_);
+	mapping_ = nullptr;
+	file_ = nullptr;
+#else
+	if(data_) munmap(const_cast<char*>(data_), size_);
+#endif
+	data_ = nullptr;
+	size_ = 0;
+	is_open_ = false;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ofConstants.h"
+#include <filesystem>
+#include <cstddef>
+
+// read-only memory mapping of a whole file.
+// pages are faulted in by the OS on first touch, nothing is copied.
+class MappedFile
+{
+public:
+	MappedFile(){}
+	MappedFile(const std::filesystem::path &filepath) { open(filepath); }
+	~MappedFile() { close(); }
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::filesystem::path &filepath);
+	void close();
+	bool isOpen() const { return is_open_; }
+	const char* data() const { return data_; }
+	std::size_t size() const { return size_; }
+private:
+	bool is_open_=false;
+	const char *data_=nullptr;
+	std::size_t size_=0;
+#ifdef TARGET_WIN32
+	void *file_=nullptr;
+	void *mapping_=nullptr;
+#endif
+};
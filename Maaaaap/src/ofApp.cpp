@@ -3,6 +3,9 @@
 #include "BlendingEditor.h"
 #include "WarpingEditor.h"
 #include "ResourceStorage.h"
+#include "RenderGraph.h"
+#include "OutputRenderer.h"
+#include "ProjectFile.h"
 #include "gui/Gui.h"
 #include "imgui_internal.h"
 #include "AppGui.h"
@@ -21,8 +24,23 @@ public:
 	App():mode_(WARP, NUM_MODE) {
 	}
 	void setup() {
-		auto window_rect = ofGetWindowRect();
 		ofDisableArbTex();
+		if(!std::filesystem::exists(projectPath()) || !loadProject(projectPath(), storage_)) {
+			setupSampleGraph();
+		}
+		
+		warp_mesh_info_.setup();
+		blend_mesh_info_.setup();
+		output_info_.setup();
+		shader_.setup();
+		auto &p = shader_.getParams();
+		p.gamma = {1,1,1};
+		p.blend_power = 0.5f;
+		p.luminance_control = 0.5f;
+		p.base_color = {0,0,0};
+	}
+	void setupSampleGraph() {
+		auto window_rect = ofGetWindowRect();
 		auto source = make_shared<Source>();
 		{
 			auto image = std::make_shared<ImageFile>();
@@ -78,7 +96,22 @@ public:
 			blending2->texture_uv_for_frame_ = {0.f,0.f,0.5f,1.f};
 		}
 		auto o = make_shared<Output>();
+		{
+			ofRectangle rect = window_rect;
+			auto fbo = make_shared<Fbo>();
+			fbo->get().allocate(rect.width, rect.height, GL_RGBA);
+			o->set(fbo);
+			o->setRect(rect);
+		}
 		auto o2 = make_shared<Output>();
+		{
+			ofRectangle rect = window_rect;
+			rect.x += rect.width;
+			auto fbo = make_shared<Fbo>();
+			fbo->get().allocate(rect.width, rect.height, GL_RGBA);
+			o2->set(fbo);
+			o2->setRect(rect);
+		}
 		storage_.bind(warp, source);
 		storage_.bind(warp, rt);
 		storage_.bind(warp2, source2);
@@ -87,59 +120,53 @@ public:
 		storage_.bind(blending, o);
 		storage_.bind(blending2, rt2);
 		storage_.bind(blending2, o2);
-		
-		warp_mesh_info_.setup();
-		blend_mesh_info_.setup();
-		output_info_.setup();
-		shader_.setup();
-		auto &p = shader_.getParams();
-		p.gamma = {1,1,1};
-		p.blend_power = 0.5f;
-		p.luminance_control = 0.5f;
-		p.base_color = {0,0,0};
 	}
 	void update() {
 		updateWarpTexture();
+		output_renderer_.render(storage_, shader_);
 	}
 	void draw() const {
+		for(auto &&o : storage_.getContainer<Output>()) {
+			if(o->get()) {
+				o->getTexture().draw(o->getRect());
+			}
+		}
 	}
 	void gui() {
 		using namespace ImGui;
 		{
-			static std::shared_ptr<Source> src_selected = nullptr;
 			if(Begin("Sources")) {
 				auto src = storage_.getContainer<Source>();
 				int i = 0;
 				char buf[256]={};
 				for(auto &&s : src) {
 					ImFormatString(buf, 256, "%s%d", "source", i++);
-					if(Selectable(buf, src_selected == s)) {
-						src_selected = s;
+					if(Selectable(buf, src_selected_ == s)) {
+						src_selected_ = s;
 					}
 				}
 			}
 			End();
-			if(Begin("Source_preview") && src_selected) {
-				source_info_.Info(src_selected);
+			if(Begin("Source_preview") && src_selected_) {
+				source_info_.Info(src_selected_);
 			}
 			End();
 		}
 		{
-			static std::shared_ptr<WarpingMesh> warp_selected = nullptr;
 			if(Begin("WarpingMeshes")) {
 				auto warp = storage_.getContainer<WarpingMesh>();
 				int i = 0;
 				char buf[256]={};
 				for(auto &&w : warp) {
 					ImFormatString(buf, 256, "%s%d", "warp", i++);
-					if(Selectable(buf, warp_selected == w)) {
-						warp_selected = w;
+					if(Selectable(buf, warp_selected_ == w)) {
+						warp_selected_ = w;
 					}
 				}
 			}
 			End();
-			if(Begin("WarpingMesh_input") && warp_selected) {
-				auto source = storage_.getSourceFor(warp_selected);
+			if(Begin("WarpingMesh_input") && warp_selected_) {
+				auto source = storage_.getSourceFor(warp_selected_);
 				if(BeginCombo("source", "---select a source---")) {
 					auto src = storage_.getContainer<Source>();
 					int i = 0;
@@ -147,29 +174,29 @@ public:
 					for(auto &&s : src) {
 						ImFormatString(buf, 256, "%s%d", "source", i++);
 						if(Selectable(buf, source == s)) {
-							storage_.bind(warp_selected, s);
+							storage_.bind(warp_selected_, s);
 						}
 					}
 					EndCombo();
 				}
-				warp_mesh_info_.EditUV(warp_selected, storage_);
+				warp_mesh_info_.EditUV(warp_selected_, storage_);
 			}
 			End();
-			if(Begin("WarpingMesh_output") && warp_selected) {
-				auto target_selected = storage_.getRenderTextureIncluding(warp_selected);
+			if(Begin("WarpingMesh_output") && warp_selected_) {
+				auto target = storage_.getRenderTextureIncluding(warp_selected_);
 				if(BeginCombo("target", "---select a target---")) {
-					auto target = storage_.getContainer<RenderTexture>();
+					auto targets = storage_.getContainer<RenderTexture>();
 					int i = 0;
 					char buf[256]={};
-					for(auto &&t : target) {
+					for(auto &&t : targets) {
 						ImFormatString(buf, 256, "%s%d", "target", i++);
-						if(Selectable(buf, target_selected == t)) {
-							storage_.bind(warp_selected, t);
+						if(Selectable(buf, target == t)) {
+							storage_.bind(warp_selected_, t);
 						}
 					}
 					EndCombo();
 				}
-				warp_mesh_info_.EditMesh(warp_selected, storage_);
+				warp_mesh_info_.EditMesh(warp_selected_, storage_);
 			}
 			else {
 				warp_mesh_info_.inactivateInteraction();
@@ -177,40 +204,38 @@ public:
 			End();
 		}
 		{
-			static std::shared_ptr<RenderTexture> target_selected = nullptr;
 			if(Begin("RenderTextures")) {
 				auto texture = storage_.getContainer<RenderTexture>();
 				int i = 0;
 				char buf[256]={};
 				for(auto &&t : texture) {
 					ImFormatString(buf, 256, "%s%d", "texture", i++);
-					if(Selectable(buf, target_selected == t)) {
-						target_selected = t;
+					if(Selectable(buf, target_selected_ == t)) {
+						target_selected_ = t;
 					}
 				}
 			}
 			End();
-			if(Begin("RenderTexture_preview") && target_selected) {
-				target_info_.Info(target_selected);
+			if(Begin("RenderTexture_preview") && target_selected_) {
+				target_info_.Info(target_selected_);
 			}
 			End();
 		}
 		{
-			static std::shared_ptr<BlendingMesh> blend_selected = nullptr;
 			if(Begin("BlendingMeshes")) {
 				auto blend = storage_.getContainer<BlendingMesh>();
 				int i = 0;
 				char buf[256]={};
 				for(auto &&b : blend) {
 					ImFormatString(buf, 256, "%s%d", "blend", i++);
-					if(Selectable(buf, blend_selected == b)) {
-						blend_selected = b;
+					if(Selectable(buf, blend_selected_ == b)) {
+						blend_selected_ = b;
 					}
 				}
 			}
 			End();
-			if(Begin("BlendingMesh_input") && blend_selected) {
-				auto source = storage_.getRenderTextureReferencedBy(blend_selected);
+			if(Begin("BlendingMesh_input") && blend_selected_) {
+				auto source = storage_.getRenderTextureReferencedBy(blend_selected_);
 				if(BeginCombo("render texture", "---select a render texture---")) {
 					auto textures = storage_.getContainer<RenderTexture>();
 					int i = 0;
@@ -218,29 +243,29 @@ public:
 					for(auto &&t : textures) {
 						ImFormatString(buf, 256, "%s%d", "texture", i++);
 						if(Selectable(buf, source == t)) {
-							storage_.bind(blend_selected, t);
+							storage_.bind(blend_selected_, t);
 						}
 					}
 					EndCombo();
 				}
-				blend_mesh_info_.EditUV(blend_selected, storage_);
+				blend_mesh_info_.EditUV(blend_selected_, storage_);
 			}
 			End();
-			if(Begin("BlendingMesh_output") && blend_selected) {
-				auto output_selected = storage_.getOutputFor(blend_selected);
+			if(Begin("BlendingMesh_output") && blend_selected_) {
+				auto output = storage_.getOutputFor(blend_selected_);
 				if(BeginCombo("output", "---select a output---")) {
-					auto output = storage_.getContainer<Output>();
+					auto outputs = storage_.getContainer<Output>();
 					int i = 0;
 					char buf[256]={};
-					for(auto &&o : output) {
+					for(auto &&o : outputs) {
 						ImFormatString(buf, 256, "%s%d", "output", i++);
-						if(Selectable(buf, output_selected == o)) {
-							storage_.bind(blend_selected, o);
+						if(Selectable(buf, output == o)) {
+							storage_.bind(blend_selected_, o);
 						}
 					}
 					EndCombo();
 				}
-				blend_mesh_info_.EditMesh(blend_selected, storage_, shader_);
+				blend_mesh_info_.EditMesh(blend_selected_, storage_, shader_);
 			}
 			else {
 				blend_mesh_info_.inactivateInteraction();
@@ -248,30 +273,73 @@ public:
 			End();
 		}
 		{
-			static std::shared_ptr<Output> output_selected = nullptr;
 			if(Begin("Output")) {
 				auto src = storage_.getContainer<Output>();
 				int i = 0;
 				char buf[256]={};
 				for(auto &&s : src) {
 					ImFormatString(buf, 256, "%s%d", "output", i++);
-					if(Selectable(buf, output_selected == s)) {
-						output_selected = s;
+					if(Selectable(buf, output_selected_ == s)) {
+						output_selected_ = s;
 					}
 				}
 			}
 			End();
 			if(Begin("Output_preview")) {
-				output_info_.EditMesh(output_selected, storage_, shader_);
+				output_info_.EditMesh(output_selected_, storage_, shader_);
 			}
 			else {
 				output_info_.inactivateInteraction();
 			}
 			End();
 		}
+		if(Begin("OutputRenderer")) {
+			auto &stats = output_renderer_.getStats();
+			Text("total : %.3fms", stats.micros/1000.f);
+			auto &outputs = storage_.getContainer<Output>();
+			for(auto &&o : stats.outputs) {
+				auto index = std::distance(begin(outputs), outputs.find(o.output));
+				Text("output%d : cull %.3fms, draw %.3fms", (int)index, o.cull_micros/1000.f, o.draw_micros/1000.f);
+				Text("  %d drawn in %d batches, %d culled", (int)o.num_drawn, (int)o.num_batches, (int)o.num_culled);
+			}
+		}
+		End();
+		if(Begin("RenderGraph")) {
+			auto &stats = render_graph_.getStats();
+			Text("rendered : %d, skipped : %d", (int)stats.num_rendered, (int)stats.num_skipped);
+			Text("total : %.3fms", stats.micros/1000.f);
+			auto &textures = storage_.getContainer<RenderTexture>();
+			for(auto &&n : stats.nodes) {
+				auto index = std::distance(begin(textures), textures.find(n.target));
+				if(n.is_rendered) {
+					Text("texture%d : %.3fms", (int)index, n.micros/1000.f);
+				}
+				else {
+					TextDisabled("texture%d : skipped", (int)index);
+				}
+			}
+		}
+		End();
 	}
 
 	void keyPressed(int key){
+		if(ImGui::GetIO().WantCaptureKeyboard) {
+			return;
+		}
+		if(!ImGui::IsModKeyDown(ImGuiKeyModFlags_Ctrl) && !ImGui::IsModKeyDown(ImGuiKeyModFlags_Super)) {
+			return;
+		}
+		switch(key) {
+			case 's':
+				saveProject(storage_, projectPath());
+				break;
+			case 'o':
+				if(loadProject(projectPath(), storage_)) {
+					render_graph_.invalidate();
+					clearSelection();
+				}
+				break;
+		}
 	}
 private:
 	mutable ofxBlendScreen::Shader shader_;
@@ -295,19 +363,28 @@ private:
 	};
 	Wrap<int> mode_;
 	
+	// what the inspectors show; nodes of the graph, so a load has to drop them
+	std::shared_ptr<Source> src_selected_;
+	std::shared_ptr<WarpingMesh> warp_selected_;
+	std::shared_ptr<RenderTexture> target_selected_;
+	std::shared_ptr<BlendingMesh> blend_selected_;
+	std::shared_ptr<Output> output_selected_;
+	void clearSelection() {
+		src_selected_ = nullptr;
+		warp_selected_ = nullptr;
+		target_selected_ = nullptr;
+		blend_selected_ = nullptr;
+		output_selected_ = nullptr;
+	}
+	
+	RenderGraph render_graph_;
+	OutputRenderer output_renderer_;
+	
+	std::filesystem::path projectPath() const {
+		return ofToDataPath("project.mgraph");
+	}
 	void updateWarpTexture() {
-		auto render_textures = storage_.getContainer<RenderTexture>();
-		for(auto &&r : render_textures) {
-			r->begin();
-			ofClear(0);
-			for(auto &&w : storage_.getWarpsBoundTo(r)) {
-				auto tex = storage_.getSourceFor(w);
-				tex->getTexture().bind();
-				w->getMesh().draw();
-				tex->getTexture().unbind();
-			}
-			r->end();
-		}
+		render_graph_.update(storage_);
 	}
 };
 
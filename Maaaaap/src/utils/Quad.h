@@ -18,6 +18,8 @@ struct Quad {
 	Quad(Quad &&q):Quad(q.pt){}
 	Quad& operator=(const Quad &q) { lt = q.lt; rt = q.rt; lb = q.lb; rb = q.rb; return *this; }
 	Quad& operator=(Quad &&q) { lt = q.lt; rt = q.rt; lb = q.lb; rb = q.rb; return *this; }
+	bool operator==(const Quad &q) const { return lt == q.lt && rt == q.rt && lb == q.lb && rb == q.rb; }
+	bool operator!=(const Quad &q) const { return !(*this == q); }
 	value_type& operator[](std::size_t index) { return pt[index]; }
 	const value_type& operator[](std::size_t index) const { return pt[index]; }
 	std::size_t size() const { return 4; }
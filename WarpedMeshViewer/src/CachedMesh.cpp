@@ -0,0 +1,278 @@
+#include "CachedMesh.h"
+#include "Bytes.h"
+#include "ofMesh.h"
+#include "ofGLUtils.h"
+#include "ofUtils.h"
+#include "ofLog.h"
+#include <fstream>
+
+namespace {
+const char MAGIC[4] = {'W','M','V','C'};
+const std::uint32_t VERSION = 1;
+// position of the mtime in the header, so a touched but unchanged file only patches it
+const std::size_t MTIME_OFFSET = 24;
+enum {
+	VERTEX, NORMAL, TEXCOORD, COLOR, INDEX,
+	NUM_ARRAYS
+};
+
+std::uint64_t hash(const char *data, std::size_t size)
+{
+	// FNV-1a; it only backs up size and mtime
+	std::uint64_t h = 0xcbf29ce484222325ULL;
+	for(std::size_t i = 0; i < size; ++i) {
+		h ^= static_cast<std::uint8_t>(data[i]);
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+template<typename T>
+bool getArray(ByteReader &reader, const T *&dst, std::size_t count)
+{
+	if(!reader.align(16)) {
+		return false;
+	}
+	dst = count > 0 ? reinterpret_cast<const T*>(reader.data()+reader.tell()) : nullptr;
+	return reader.skip(sizeof(T)*count);
+}
+}
+
+std::filesystem::path CachedMesh::getCachePath(const std::filesystem::path &filepath)
+{
+	auto ret = filepath;
+	return ret += ".vbocache";
+}
+
+bool CachedMesh::getKey(const std::filesystem::path &filepath, Key &key, bool with_hash)
+{
+	std::error_code ec;
+	key.size = std::filesystem::file_size(filepath, ec);
+	if(ec) {
+		return false;
+	}
+	key.mtime = std::filesystem::last_write_time(filepath, ec).time_since_epoch().count();
+	if(ec) {
+		return false;
+	}
+	if(with_hash) {
+		MappedFile file(filepath);
+		if(!file.isOpen()) {
+			return false;
+		}
+		key.hash = hash(file.data(), file.size());
+	}
+	return true;
+}
+
+bool CachedMesh::load(const std::filesystem::path &filepath)
+{
+	auto path = std::filesystem::path(ofToDataPath(filepath, true));
+	auto cache_path = getCachePath(path);
+	is_from_cache_ = readCache(path, cache_path);
+	return is_from_cache_ || buildCache(path, cache_path);
+}
+
+bool CachedMesh::readCache(const std::filesystem::path &filepath, const std::filesystem::path &cache_path)
+{
+	// arrays are used in place, so the cache is only usable in the byte order it was written in
+	std::error_code ec;
+	if(!bytes::isHostLittleEndian() || !std::filesystem::exists(cache_path, ec)) {
+		return false;
+	}
+	Key key, cached;
+	if(!getKey(filepath, key, false) || !mapped_.open(cache_path) || !setArrays(mapped_.data(), mapped_.size(), &cached)) {
+		mapped_.close();
+		return false;
+	}
+	if(key.size != cached.size) {
+		mapped_.close();
+		return false;
+	}
+	if(key.mtime == cached.mtime) {
+		return true;
+	}
+	// touched or copied over; only the content decides
+	if(!getKey(filepath, key, true) || key.hash != cached.hash) {
+		mapped_.close();
+		return false;
+	}
+	// the arrays point into the mapping, so it's let go while patching and mapped again after
+	mapped_.close();
+	{
+		std::fstream file(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(MTIME_OFFSET);
+		file.write(reinterpret_cast<const char*>(&key.mtime), sizeof(key.mtime));
+		file.flush();
+		if(!file) {
+			// still a hit this time; the next load hashes again
+			ofLogWarning("CachedMesh") << "failed to update cache: " << cache_path;
+		}
+	}
+	if(!mapped_.open(cache_path) || !setArrays(mapped_.data(), mapped_.size())) {
+		mapped_.close();
+		return false;
+	}
+	return true;
+}
+
+bool CachedMesh::buildCache(const std::filesystem::path &filepath, const std::filesystem::path &cache_path)
+{
+	// taken before parsing, so a file replaced meanwhile doesn't match the cache next time
+	Key key;
+	if(!getKey(filepath, key, true)) {
+		ofLogError("CachedMesh") << "failed to read: " << filepath;
+		return false;
+	}
+	ofMesh mesh;
+	mesh.load(filepath.string());
+	if(mesh.getNumVertices() == 0) {
+		ofLogError("CachedMesh") << "no vertices in: " << filepath;
+		return false;
+	}
+	if((mesh.getNumNormals() > 0 && mesh.getNumNormals() != mesh.getNumVertices())
+	   || (mesh.getNumTexCoords() > 0 && mesh.getNumTexCoords() != mesh.getNumVertices())
+	   || (mesh.getNumColors() > 0 && mesh.getNumColors() != mesh.getNumVertices())) {
+		ofLogError("CachedMesh") << "attribute count doesn't match vertices in: " << filepath;
+		return false;
+	}
+	// a file cut off while being written can still parse
+	for(auto &&index : mesh.getIndices()) {
+		if(index >= mesh.getNumVertices()) {
+			ofLogError("CachedMesh") << "index out of range in: " << filepath;
+			return false;
+		}
+	}
+	ByteWriter writer;
+	writer.putBytes(MAGIC, 4);
+	writer.put(VERSION);
+	writer.put(std::uint32_t(sizeof(ofIndexType)));
+	writer.put(std::uint32_t(mesh.getMode()));
+	writer.put(key.size);
+	writer.put(key.mtime);
+	writer.put(key.hash);
+	std::uint32_t counts[NUM_ARRAYS] = {
+		(std::uint32_t)mesh.getNumVertices(),
+		(std::uint32_t)mesh.getNumNormals(),
+		(std::uint32_t)mesh.getNumTexCoords(),
+		(std::uint32_t)mesh.getNumColors(),
+		(std::uint32_t)mesh.getNumIndices(),
+	};
+	writer.putArray(counts, NUM_ARRAYS);
+	writer.putArray(&mesh.getVertices()[0].x, counts[VERTEX]*3);
+	writer.putArray(counts[NORMAL] > 0 ? &mesh.getNormals()[0].x : nullptr, counts[NORMAL]*3);
+	writer.putArray(counts[TEXCOORD] > 0 ? &mesh.getTexCoords()[0].x : nullptr, counts[TEXCOORD]*2);
+	writer.putArray(counts[COLOR] > 0 ? &mesh.getColors()[0].r : nullptr, counts[COLOR]*4);
+	writer.putArray(counts[INDEX] > 0 ? mesh.getIndexPointer() : nullptr, counts[INDEX]);
+
+	if(bytes::isHostLittleEndian()) {
+		// written aside and renamed, so a reader never maps half a file
+		auto temp_path = cache_path;
+		temp_path += ".tmp";
+		std::error_code ec;
+		{
+			std::ofstream file(temp_path, std::ios::binary);
+			file.write(writer.data(), writer.size());
+			if(!file) {
+				ec = std::make_error_code(std::errc::io_error);
+			}
+		}
+		if(!ec) {
+			std::filesystem::rename(temp_path, cache_path, ec);
+		}
+		if(ec) {
+			std::filesystem::remove(temp_path, ec);
+			ofLogWarning("CachedMesh") << "failed to write cache: " << cache_path;
+		}
+	}
+	built_ = writer.release();
+	return setArrays(built_.data(), built_.size());
+}
+
+bool CachedMesh::setArrays(const char *data, std::size_t size, Key *key)
+{
+	ByteReader reader(data, size);
+	char magic[4];
+	std::uint32_t version, index_size, mode;
+	Key k;
+	std::uint32_t counts[NUM_ARRAYS];
+	if(!reader.getBytes(magic, 4) || memcmp(magic, MAGIC, 4) != 0
+	   || !reader.get(version) || version != VERSION
+	   || !reader.get(index_size) || index_size != sizeof(ofIndexType)
+	   || !reader.get(mode)
+	   || !reader.get(k.size) || !reader.get(k.mtime) || !reader.get(k.hash)
+	   || !reader.getArray(counts, NUM_ARRAYS)) {
+		return false;
+	}
+	if(mode > OF_PRIMITIVE_POINTS) {
+		return false;
+	}
+	// the vbo reads every attribute as far as the vertices go
+	for(int i : {NORMAL, TEXCOORD, COLOR}) {
+		if(counts[i] != 0 && counts[i] != counts[VERTEX]) {
+			return false;
+		}
+	}
+	const glm::vec3 *vertices;
+	const glm::vec3 *normals;
+	const glm::vec2 *texcoords;
+	const ofFloatColor *colors;
+	const ofIndexType *indices;
+	if(!getArray(reader, vertices, counts[VERTEX])
+	   || !getArray(reader, normals, counts[NORMAL])
+	   || !getArray(reader, texcoords, counts[TEXCOORD])
+	   || !getArray(reader, colors, counts[COLOR])
+	   || !getArray(reader, indices, counts[INDEX])) {
+		return false;
+	}
+	// a damaged cache must not send the gpu reading past the vertices
+	for(std::size_t i = 0; i < counts[INDEX]; ++i) {
+		if(indices[i] >= counts[VERTEX]) {
+			return false;
+		}
+	}
+	vertices_ = vertices;
+	normals_ = normals;
+	texcoords_ = texcoords;
+	colors_ = colors;
+	indices_ = indices;
+	mode_ = static_cast<ofPrimitiveMode>(mode);
+	num_vertices_ = counts[VERTEX];
+	num_normals_ = counts[NORMAL];
+	num_texcoords_ = counts[TEXCOORD];
+	num_colors_ = counts[COLOR];
+	num_indices_ = counts[INDEX];
+	if(key) {
+		*key = k;
+	}
+	return true;
+}
+
+void CachedMesh::upload()
+{
+	vbo_.clear();
+	vbo_.setVertexData(vertices_, num_vertices_, GL_STATIC_DRAW);
+	if(num_normals_ > 0) vbo_.setNormalData(normals_, num_normals_, GL_STATIC_DRAW);
+	if(num_texcoords_ > 0) vbo_.setTexCoordData(texcoords_, num_texcoords_, GL_STATIC_DRAW);
+	if(num_colors_ > 0) vbo_.setColorData(colors_, num_colors_, GL_STATIC_DRAW);
+	if(num_indices_ > 0) vbo_.setIndexData(indices_, num_indices_, GL_STATIC_DRAW);
+	vertices_ = normals_ = nullptr;
+	texcoords_ = nullptr;
+	colors_ = nullptr;
+	indices_ = nullptr;
+	mapped_.close();
+	std::vector<char>().swap(built_);
+	is_uploaded_ = true;
+}
+
+void CachedMesh::draw() const
+{
+	if(!is_uploaded_) {
+		return;
+	}
+	if(num_indices_ > 0) {
+		vbo_.drawElements(ofGetGLPrimitiveMode(mode_), num_indices_);
+	}
+	else {
+		vbo_.draw(ofGetGLPrimitiveMode(mode_), 0, num_vertices_);
+	}
+}
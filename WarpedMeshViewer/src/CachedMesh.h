@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ofVbo.h"
+#include "MappedFile.h"
+#include <filesystem>
+#include <cstdint>
+
+// a mesh file loaded through a binary cache kept next to it(<file>.vbocache).
+// the cache holds the arrays exactly as they go to the vbo, so a hit is one memory mapping
+// and one copy per attribute. it's keyed by size, mtime and content hash of the mesh file
+// and rebuilt with ofMesh::load when they don't match.
+// load() doesn't touch GL and can run on any thread; upload() and draw() need the GL thread.
+class CachedMesh
+{
+public:
+	bool load(const std::filesystem::path &filepath);
+	// copies the arrays into the vbo and lets go of them
+	void upload();
+	void draw() const;
+
+	bool isUploaded() const { return is_uploaded_; }
+	bool isFromCache() const { return is_from_cache_; }
+	std::size_t getNumVertices() const { return num_vertices_; }
+private:
+	struct Key {
+		std::uint64_t size=0;
+		std::int64_t mtime=0;
+		std::uint64_t hash=0;
+	};
+	static std::filesystem::path getCachePath(const std::filesystem::path &filepath);
+	static bool getKey(const std::filesystem::path &filepath, Key &key, bool with_hash);
+	bool readCache(const std::filesystem::path &filepath, const std::filesystem::path &cache_path);
+	bool buildCache(const std::filesystem::path &filepath, const std::filesystem::path &cache_path);
+	// points the arrays into data, which is laid out like the cache file
+	bool setArrays(const char *data, std::size_t size, Key *key=nullptr);
+
+	// the arrays point into one of these until uploaded
+	MappedFile mapped_;
+	std::vector<char> built_;
+	const glm::vec3 *vertices_=nullptr, *normals_=nullptr;
+	const glm::vec2 *texcoords_=nullptr;
+	const ofFloatColor *colors_=nullptr;
+	const ofIndexType *indices_=nullptr;
+	std::size_t num_vertices_=0, num_normals_=0, num_texcoords_=0, num_colors_=0, num_indices_=0;
+	ofPrimitiveMode mode_=OF_PRIMITIVE_TRIANGLES;
+
+	ofVbo vbo_;
+	bool is_uploaded_=false;
+	bool is_from_cache_=false;
+};
@@ -0,0 +1,105 @@
+#include "MeshReloader.h"
+#include "ofUtils.h"
+#include "ofLog.h"
+
+MeshReloader::~MeshReloader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		is_exiting_ = true;
+	}
+	exit_cv_.notify_all();
+	if(thread_.joinable()) {
+		thread_.join();
+	}
+}
+
+bool MeshReloader::getStamp(const std::filesystem::path &filepath, Stamp &stamp)
+{
+	std::error_code ec;
+	stamp.size = std::filesystem::file_size(filepath, ec);
+	if(ec) {
+		return false;
+	}
+	stamp.mtime = std::filesystem::last_write_time(filepath, ec);
+	return !ec;
+}
+
+std::unique_ptr<CachedMesh> MeshReloader::load(const char *what)
+{
+	auto start = ofGetElapsedTimeMicros();
+	auto mesh = std::make_unique<CachedMesh>();
+	if(!mesh->load(filepath_)) {
+		return nullptr;
+	}
+	ofLogNotice("MeshReloader") << what << " " << filepath_ << " in " << (ofGetElapsedTimeMicros()-start)/1000.f << "ms"
+		<< (mesh->isFromCache() ? " from cache" : ", cache rebuilt");
+	return mesh;
+}
+
+bool MeshReloader::setup(const std::filesystem::path &filepath, std::chrono::milliseconds interval)
+{
+	if(thread_.joinable()) {
+		ofLogError("MeshReloader") << "already watching: " << filepath_;
+		return false;
+	}
+	filepath_ = ofToDataPath(filepath, true);
+	interval_ = interval;
+	// stamped before loading, so a change during the load is picked up by the worker
+	Stamp stamp;
+	getStamp(filepath_, stamp);
+	mesh_ = load("loaded");
+	if(mesh_) {
+		mesh_->upload();
+	}
+	thread_ = std::thread(&MeshReloader::threadedFunction, this, stamp);
+	return mesh_ != nullptr;
+}
+
+bool MeshReloader::update()
+{
+	std::unique_ptr<CachedMesh> mesh;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		mesh = std::move(pending_);
+	}
+	if(!mesh) {
+		return false;
+	}
+	mesh->upload();
+	// the old vbo goes away here on the GL thread
+	mesh_ = std::move(mesh);
+	return true;
+}
+
+void MeshReloader::draw() const
+{
+	if(mesh_) {
+		mesh_->draw();
+	}
+}
+
+void MeshReloader::threadedFunction(Stamp loaded)
+{
+	Stamp last_seen = loaded;
+	std::unique_lock<std::mutex> lock(mutex_);
+	while(!exit_cv_.wait_for(lock, interval_, [this]{ return is_exiting_; })) {
+		lock.unlock();
+		Stamp stamp;
+		// the exporter may still be writing; wait until one poll sees the same stamp as the last
+		if(getStamp(filepath_, stamp) && stamp != loaded && stamp == last_seen) {
+			loaded = stamp;
+			if(auto mesh = load("reloaded")) {
+				lock.lock();
+				// not uploaded yet, so a replaced one has nothing on the GPU to free
+				pending_ = std::move(mesh);
+				lock.unlock();
+			}
+			else {
+				ofLogWarning("MeshReloader") << "keeping the last good mesh";
+			}
+		}
+		last_seen = stamp;
+		lock.lock();
+	}
+}
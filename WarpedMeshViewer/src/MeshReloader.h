@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CachedMesh.h"
+#include <filesystem>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// keeps a mesh in sync with its file while the app is running.
+// a worker thread polls the file's size and mtime, and once a change has settled for one interval
+// it loads the new version there. update() uploads it and swaps it in between two frames.
+// a version that fails to load is skipped and the last good mesh stays on screen.
+class MeshReloader
+{
+public:
+	MeshReloader(){}
+	~MeshReloader();
+	MeshReloader(const MeshReloader&) = delete;
+	MeshReloader& operator=(const MeshReloader&) = delete;
+
+	// loads the file right away, then starts watching it
+	bool setup(const std::filesystem::path &filepath, std::chrono::milliseconds interval=std::chrono::milliseconds(500));
+	// call on the GL thread before drawing. true when a new version was swapped in
+	bool update();
+	void draw() const;
+private:
+	struct Stamp {
+		std::uintmax_t size=0;
+		std::filesystem::file_time_type mtime;
+		bool operator==(const Stamp &s) const { return size == s.size && mtime == s.mtime; }
+		bool operator!=(const Stamp &s) const { return !(*this == s); }
+	};
+	static bool getStamp(const std::filesystem::path &filepath, Stamp &stamp);
+	// on the worker; empty if the file couldn't be loaded
+	std::unique_ptr<CachedMesh> load(const char *what);
+	void threadedFunction(Stamp loaded);
+
+	std::filesystem::path filepath_;
+	std::chrono::milliseconds interval_;
+	std::unique_ptr<CachedMesh> mesh_;
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable exit_cv_;
+	bool is_exiting_=false;
+	// loaded but not uploaded yet; a newer one replaces it
+	std::unique_ptr<CachedMesh> pending_;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// byte order helpers for the binary mesh cache.
+// everything is stored little endian; conversion is a no-op on little endian hosts.
+namespace bytes {
+inline bool isHostLittleEndian() {
+	const std::uint16_t one = 1;
+	return *reinterpret_cast<const std::uint8_t*>(&one) == 1;
+}
+template<typename T>
+inline void swapOrder(T *data, std::size_t count) {
+	static_assert(std::is_arithmetic<T>::value, "only scalars can be swapped");
+	if(sizeof(T) == 1 || isHostLittleEndian()) {
+		return;
+	}
+	for(std::size_t i = 0; i < count; ++i) {
+		auto *p = reinterpret_cast<std::uint8_t*>(data+i);
+		for(std::size_t b = 0; b < sizeof(T)/2; ++b) {
+			std::swap(p[b], p[sizeof(T)-1-b]);
+		}
+	}
+}
+inline std::size_t alignUp(std::size_t pos, std::size_t alignment) {
+	return alignment > 1 ? (pos+alignment-1)/alignment*alignment : pos;
+}
+}
+
+class ByteWriter
+{
+public:
+	template<typename T>
+	void put(const T &t) {
+		putArray(&t, 1, 1);
+	}
+	void putBytes(const void *data, std::size_t size) {
+		auto pos = buf_.size();
+		buf_.resize(pos+size);
+		if(size > 0) {
+			memcpy(buf_.data()+pos, data, size);
+		}
+	}
+	// copies the whole array in one go, starting at an aligned position
+	template<typename T>
+	void putArray(const T *data, std::size_t count, std::size_t alignment=16) {
+		align(alignment);
+		auto pos = buf_.size();
+		putBytes(data, sizeof(T)*count);
+		bytes::swapOrder(reinterpret_cast<T*>(buf_.data()+pos), count);
+	}
+	template<typename T>
+	void patch(std::size_t pos, const T &t) {
+		memcpy(buf_.data()+pos, &t, sizeof(T));
+		bytes::swapOrder(reinterpret_cast<T*>(buf_.data()+pos), 1);
+	}
+	void align(std::size_t alignment) {
+		buf_.resize(bytes::alignUp(buf_.size(), alignment), 0);
+	}
+	std::size_t size() const { return buf_.size(); }
+	const char* data() const { return buf_.data(); }
+	void reserve(std::size_t size) { buf_.reserve(size); }
+	void clear() { buf_.clear(); }
+	// hands the buffer over without copying, leaving the writer empty
+	std::vector<char> release() { return std::move(buf_); }
+private:
+	std::vector<char> buf_;
+};
+
+// bounds checked cursor over a byte range.
+// once a read fails every following read fails too, like std::istream.
+class ByteReader
+{
+public:
+	ByteReader(const char *data, std::size_t size):data_(data),size_(size){}
+	template<typename T>
+	bool get(T &t) {
+		return getArray(&t, 1, 1);
+	}
+	bool getBytes(void *dst, std::size_t size) {
+		if(!good_ || size_-pos_ < size) {
+			good_ = false;
+			return false;
+		}
+		if(size > 0) {
+			memcpy(dst, data_+pos_, size);
+		}
+		pos_ += size;
+		return true;
+	}
+	template<typename T>
+	bool getArray(T *dst, std::size_t count, std::size_t alignment=16) {
+		if(!align(alignment) || !getBytes(dst, sizeof(T)*count)) {
+			return false;
+		}
+		bytes::swapOrder(dst, count);
+		return true;
+	}
+	template<typename T>
+	bool getArray(std::vector<T> &dst, std::size_t count, std::size_t alignment=16) {
+		if(!good_ || count > (size_-pos_)/sizeof(T)) {
+			good_ = false;
+			return false;
+		}
+		dst.resize(count);
+		return getArray(dst.data(), count, alignment);
+	}
+	bool align(std::size_t alignment) {
+		return seek(bytes::alignUp(pos_, alignment));
+	}
+	bool seek(std::size_t pos) {
+		if(!good_ || pos > size_) {
+			good_ = false;
+			return false;
+		}
+		pos_ = pos;
+		return true;
+	}
+	bool skip(std::size_t size) { return size_-pos_ >= size ? seek(pos_+size) : (good_ = false); }
+	bool good() const { return good_; }
+	bool eof() const { return pos_ >= size_; }
+	std::size_t tell() const { return pos_; }
+	std::size_t size() const { return size_; }
+	const char* data() const { return data_; }
+private:
+	const char *data_;
+	std::size_t size_;
+	std::size_t pos_=0;
+	bool good_=true;
+};
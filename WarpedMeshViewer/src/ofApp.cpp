@@ -2,19 +2,18 @@
 
 namespace {
 ofTexture texture_;
-ofMesh mesh_;
 }
 
 //--------------------------------------------------------------
 void ofApp::setup(){
 //	ofDisableArbTex();
 	ofLoadImage(texture_, "of.png");
-	mesh_.load("export_arb.ply");
+	mesh_.setup("export_arb.ply");
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){
-
+	mesh_.update();
 }
 
 //--------------------------------------------------------------
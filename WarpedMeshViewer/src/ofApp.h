@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include "MeshReloader.h"
 
 class ofApp : public ofBaseApp{
 
@@ -21,4 +22,7 @@ class ofApp : public ofBaseApp{
 		void dragEvent(ofDragInfo dragInfo);
 		void gotMessage(ofMessage msg);
 		
+	private:
+		// owned by the app, so its worker is joined and its vbo freed while the GL context is still around
+		MeshReloader mesh_;
 };
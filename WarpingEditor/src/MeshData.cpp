@@ -297,6 +297,48 @@ void DataContainer<Data>::unpack(std::istream &stream, const glm::vec2 &scale)
 	}
 }
 
+template<typename Data>
+void DataContainer<Data>::pack(ByteWriter &writer, const glm::vec2 &scale) const
+{
+	writer.put<std::uint64_t>(data_.size());
+	for(auto &&d : data_) {
+		writer.put<std::uint32_t>(d.first.size());
+		writer.putBytes(d.first.data(), d.first.size());
+		// every record starts aligned so its bytes don't depend on what comes before
+		writer.align(16);
+		writer.mark();
+		d.second->pack(writer, scale);
+	}
+}
+
+template<typename Data>
+void DataContainer<Data>::unpack(ByteReader &reader, const glm::vec2 &scale)
+{
+	data_.clear();
+	std::uint64_t num;
+	if(!reader.get(num)) {
+		return;
+	}
+	while(num-->0) {
+		std::uint32_t name_size;
+		std::string name;
+		if(!reader.get(name_size) || name_size > reader.size()-reader.tell()) {
+			break;
+		}
+		name.resize(name_size);
+		if(!reader.getBytes(&name[0], name_size) || !reader.align(16)) {
+			break;
+		}
+		auto data = std::make_shared<Data>();
+		data->unpack(reader, scale);
+		if(!reader.good()) {
+			ofLogError("DataContainer") << "broken data: " << name;
+			break;
+		}
+		insert(data_, {name, data});
+	}
+}
+
 template<typename Data>
 std::pair<std::string, std::shared_ptr<Data>> DataContainer<Data>::createCopy(const std::string &name, std::shared_ptr<DataType> src)
 {
@@ -453,6 +495,16 @@ void BlendingData::unpack(std::istream &stream, const glm::vec2 &scale)
 	SaveData::unpack(stream, shader_->getParams());
 	DataContainer::unpack(stream, scale);
 }
+void BlendingData::pack(ByteWriter &writer, const glm::vec2 &scale) const
+{
+	SaveData::pack(writer, shader_->getParams());
+	DataContainer::pack(writer, scale);
+}
+void BlendingData::unpack(ByteReader &reader, const glm::vec2 &scale)
+{
+	SaveData::unpack(reader, shader_->getParams());
+	DataContainer::unpack(reader, scale);
+}
 
 void BlendingMesh::init(const ofRectangle &frame, float default_inner_ratio)
 {
@@ -543,9 +595,30 @@ void pack(const Quad &quad, std::ostream &stream, glm::vec2 scale) {
 	}
 }
 void unpack(Quad &quad, std::istream &stream, glm::vec2 scale) {
+	// one read for the whole quad instead of one per coordinate
+	float xy[8];
+	readFrom(stream, xy);
 	for(int i = 0; i < quad.size(); ++i) {
-		readFrom(stream, quad.pt[i].x); quad.pt[i].x *= scale.x;
-		readFrom(stream, quad.pt[i].y); quad.pt[i].y *= scale.y;
+		quad.pt[i].x = xy[i*2]*scale.x;
+		quad.pt[i].y = xy[i*2+1]*scale.y;
+	}
+}
+void pack(const Quad &quad, ByteWriter &writer, glm::vec2 scale) {
+	float xy[8];
+	for(int i = 0; i < quad.size(); ++i) {
+		xy[i*2] = quad.pt[i].x*scale.x;
+		xy[i*2+1] = quad.pt[i].y*scale.y;
+	}
+	writer.putArray(xy, 8);
+}
+void unpack(Quad &quad, ByteReader &reader, glm::vec2 scale) {
+	float xy[8];
+	if(!reader.getArray(xy, 8)) {
+		return;
+	}
+	for(int i = 0; i < quad.size(); ++i) {
+		quad.pt[i].x = xy[i*2]*scale.x;
+		quad.pt[i].y = xy[i*2+1]*scale.y;
 	}
 }
 
@@ -558,9 +631,26 @@ void MeshData::pack(std::ostream &stream, glm::vec2 scale) const
 }
 void MeshData::unpack(std::istream &stream, glm::vec2 scale)
 {
-	readFrom(stream, is_hidden);
-	readFrom(stream, is_locked);
-	readFrom(stream, is_solo);
+	bool flags[3];
+	readFrom(stream, flags);
+	is_hidden = flags[0];
+	is_locked = flags[1];
+	is_solo = flags[2];
+	setDirty();
+}
+void MeshData::pack(ByteWriter &writer, glm::vec2 scale) const
+{
+	std::uint8_t flags[4] = {is_hidden, is_locked, is_solo, 0};
+	writer.putArray(flags, 4);
+}
+void MeshData::unpack(ByteReader &reader, glm::vec2 scale)
+{
+	std::uint8_t flags[4];
+	if(reader.getArray(flags, 4)) {
+		is_hidden = flags[0];
+		is_locked = flags[1];
+		is_solo = flags[2];
+	}
 	setDirty();
 }
 
@@ -576,6 +666,63 @@ void WarpingMesh::unpack(std::istream &stream, glm::vec2 scale)
 	geom::unpack(*uv_quad, stream, scale);
 	mesh->unpack(stream, interpolator.get());
 }
+void WarpingMesh::pack(ByteWriter &writer, glm::vec2 scale) const
+{
+	MeshData::pack(writer, scale);
+	geom::pack(*uv_quad, writer, scale);
+	std::uint32_t size[2] = {(std::uint32_t)mesh->getNumCols(), (std::uint32_t)mesh->getNumRows()};
+	writer.putArray(size, 2);
+	std::size_t cols = size[0]+1, rows = size[1]+1;
+	std::vector<float> vertices(cols*rows*3), texcoords(cols*rows*2);
+	std::vector<std::uint8_t> selected(cols*rows);
+	for(std::size_t r = 0; r < rows; ++r) {
+		for(std::size_t c = 0; c < cols; ++c) {
+			auto index = r*cols+c;
+			auto point = mesh->getPoint(c, r);
+			memcpy(&vertices[index*3], point.v, sizeof(float)*3);
+			memcpy(&texcoords[index*2], point.t, sizeof(float)*2);
+			selected[index] = interpolator->isSelected(c, r);
+		}
+	}
+	writer.putArray(vertices.data(), vertices.size());
+	writer.putArray(texcoords.data(), texcoords.size());
+	writer.putArray(selected.data(), selected.size());
+}
+void WarpingMesh::unpack(ByteReader &reader, glm::vec2 scale)
+{
+	MeshData::unpack(reader, scale);
+	geom::unpack(*uv_quad, reader, scale);
+	std::uint32_t size[2];
+	if(!reader.getArray(size, 2)) {
+		return;
+	}
+	std::size_t cols = std::size_t(size[0])+1, rows = std::size_t(size[1])+1;
+	// every point takes at least a byte, so more points than bytes left is a broken header.
+	// checked by division so a huge size can't wrap the counts around; the reads below fail on it.
+	std::size_t left = reader.size()-reader.tell();
+	std::size_t num_points = rows <= left/cols ? cols*rows : left+1;
+	std::vector<float> vertices, texcoords;
+	std::vector<std::uint8_t> selected;
+	if(!reader.getArray(vertices, num_points*3)
+	   || !reader.getArray(texcoords, num_points*2)
+	   || !reader.getArray(selected, num_points)) {
+		return;
+	}
+	mesh->init(glm::ivec2(size[0], size[1]), {0,0,1,1}, {0,0,1,1});
+	interpolator->setMesh(mesh);
+	interpolator->clearAll();
+	for(std::size_t r = 0; r < rows; ++r) {
+		for(std::size_t c = 0; c < cols; ++c) {
+			auto index = r*cols+c;
+			auto point = mesh->getPoint(c, r);
+			memcpy(point.v, &vertices[index*3], sizeof(float)*3);
+			memcpy(point.t, &texcoords[index*2], sizeof(float)*2);
+			if(selected[index]) {
+				interpolator->selectPoint(c, r);
+			}
+		}
+	}
+}
 
 
 void BlendingMesh::pack(std::ostream &stream, glm::vec2 scale) const
@@ -592,14 +739,40 @@ void BlendingMesh::pack(std::ostream &stream, glm::vec2 scale) const
 void BlendingMesh::unpack(std::istream &stream, glm::vec2 scale)
 {
 	MeshData::unpack(stream, scale);
-	readFrom(stream, blend_l);
-	readFrom(stream, blend_r);
-	readFrom(stream, blend_t);
-	readFrom(stream, blend_b);
+	bool flags[4];
+	readFrom(stream, flags);
+	blend_l = flags[0];
+	blend_r = flags[1];
+	blend_t = flags[2];
+	blend_b = flags[3];
 	for(int i = 0; i < MeshType::size(); ++i) {
 		geom::unpack(mesh->quad[i], stream, scale);
 	}
 }
+void BlendingMesh::pack(ByteWriter &writer, glm::vec2 scale) const
+{
+	MeshData::pack(writer, scale);
+	std::uint8_t flags[4] = {blend_l, blend_r, blend_t, blend_b};
+	writer.putArray(flags, 4);
+	for(int i = 0; i < MeshType::size(); ++i) {
+		geom::pack(mesh->quad[i], writer, scale);
+	}
+}
+void BlendingMesh::unpack(ByteReader &reader, glm::vec2 scale)
+{
+	MeshData::unpack(reader, scale);
+	std::uint8_t flags[4];
+	if(!reader.getArray(flags, 4)) {
+		return;
+	}
+	blend_l = flags[0];
+	blend_r = flags[1];
+	blend_t = flags[2];
+	blend_b = flags[3];
+	for(int i = 0; i < MeshType::size(); ++i) {
+		geom::unpack(mesh->quad[i], reader, scale);
+	}
+}
 
 
 template class DataContainer<WarpingMesh>;
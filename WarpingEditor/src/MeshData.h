@@ -44,6 +44,8 @@ struct MeshData {
 	bool isDirty() const { return is_dirty_; }
 	void pack(std::ostream &stream, glm::vec2 scale) const;
 	void unpack(std::istream &stream, glm::vec2 scale);
+	void pack(ByteWriter &writer, glm::vec2 scale) const;
+	void unpack(ByteReader &reader, glm::vec2 scale);
 	ofMesh getMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr) const;
 	virtual ofMesh createMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr) const { return {}; }
 
@@ -81,6 +83,8 @@ struct WarpingMesh : public MeshData {
 	}
 	void pack(std::ostream &stream, glm::vec2 scale) const;
 	void unpack(std::istream &stream, glm::vec2 scale);
+	void pack(ByteWriter &writer, glm::vec2 scale) const;
+	void unpack(ByteReader &reader, glm::vec2 scale);
 };
 
 
@@ -96,6 +100,8 @@ struct BlendingMesh : public MeshData {
 	void update(){}
 	void pack(std::ostream &stream, glm::vec2 scale) const;
 	void unpack(std::istream &stream, glm::vec2 scale);
+	void pack(ByteWriter &writer, glm::vec2 scale) const;
+	void unpack(ByteReader &reader, glm::vec2 scale);
 
 	ofMesh getWireframe(const glm::vec2 &remap_coord={1,1}, const ofFloatColor &color=ofFloatColor::white) const;
 	ofMesh createMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr) const override;
@@ -151,6 +157,8 @@ public:
 
 	virtual void pack(std::ostream &stream, const glm::vec2 &scale) const override;
 	virtual void unpack(std::istream &stream, const glm::vec2 &scale) override;
+	virtual void pack(ByteWriter &writer, const glm::vec2 &scale) const override;
+	virtual void unpack(ByteReader &reader, const glm::vec2 &scale) override;
 	
 	void gui(std::function<bool(DataType&)> is_selected, std::function<void(DataType&, bool)> set_selected, std::function<void()> create_new);
 protected:
@@ -199,9 +207,12 @@ class BlendingData : public DataContainer<BlendingMesh>
 {
 public:
 	using MeshType = BlendingMesh::MeshType;
-	BlendingData() {
+	// pass false to use only the params without a GL context(e.g. from the command line)
+	BlendingData(bool setup_shader=true) {
 		shader_ = std::make_shared<ofxBlendScreen::Shader>();
-		shader_->setup();
+		if(setup_shader) {
+			shader_->setup();
+		}
 	}
 	NamedData create(const std::string &name, const ofRectangle &frame, const float &default_inner_ratio);
 	NamedData find(std::shared_ptr<MeshType> mesh);
@@ -212,6 +223,8 @@ public:
 	std::shared_ptr<ofxBlendScreen::Shader> getShader() const { return shader_; }
 	virtual void pack(std::ostream &stream, const glm::vec2 &scale) const override;
 	virtual void unpack(std::istream &stream, const glm::vec2 &scale) override;
+	virtual void pack(ByteWriter &writer, const glm::vec2 &scale) const override;
+	virtual void unpack(ByteReader &reader, const glm::vec2 &scale) override;
 private:
 	std::shared_ptr<ofxBlendScreen::Shader> shader_;
 };
@@ -0,0 +1,66 @@
+#include "ProjectExport.h"
+#include "UVMap.h"
+#include "BlendMask.h"
+
+namespace nlohmann {
+template<typename T>
+struct adl_serializer<glm::tvec3<T>> {
+	static void to_json(ofJson &j, const glm::tvec3<T> &v) {
+		j = {v[0],v[1],v[2]};
+	}
+	static void from_json(const ofJson &j, glm::tvec3<T> &v) {
+		v = {j[0],j[1],j[2]};
+	}
+};
+template<>
+struct adl_serializer<ofxBlendScreen::Shader::Params> {
+	static void to_json(ofJson &j, const ofxBlendScreen::Shader::Params &v) {
+		j = {
+			{"gamma", v.gamma},
+			{"luminance_control", v.luminance_control},
+			{"blend_power", v.blend_power},
+			{"base_color", v.base_color}
+		};
+	}
+};
+}
+
+void exportProject(const ProjectFolder &proj, const WarpingData &warp, const BlendingData &blend,
+				   const glm::vec2 &tex_size, const glm::ivec2 &bridge_resolution, std::size_t num_threads)
+{
+	std::string folder = proj.getExportFolder();
+	bool is_arb = proj.getIsExportMeshArb();
+	{
+		auto param = proj.getExportWarpParam();
+		glm::vec2 coord_size = is_arb ? glm::vec2{1,1} : glm::vec2{1/tex_size.x, 1/tex_size.y};
+		warp.exportMesh(ofFilePath::join(folder, param.filename), param.max_mesh_size, coord_size);
+	}
+	{
+		auto param = proj.getExportBlendParam();
+		glm::vec2 coord_size = is_arb ? glm::vec2{1,1} : glm::vec2{1.f/bridge_resolution.x, 1.f/bridge_resolution.y};
+		blend.exportMesh(ofFilePath::join(folder, param.filename), param.max_mesh_size, coord_size);
+	}
+	{
+		auto param = proj.getExportBlendShaderParam();
+		ofSavePrettyJson(ofFilePath::join(folder, param.filename), blend.getShader()->getParams());
+	}
+	if(proj.getExportUVMapParam().enabled) {
+		auto param = proj.getExportUVMapParam();
+		// always normalized; the map has to be valid for any texture size
+		ofMesh warped = warp.getMeshForExport(proj.getExportWarpParam().max_mesh_size, {1/tex_size.x, 1/tex_size.y});
+		BlendMask mask(num_threads);
+		if(param.with_blend) {
+			// not baked; each tile or band of the map computes its own gains
+			mask.setup(blend, bridge_resolution, false);
+		}
+		UVMap map(num_threads);
+		map.setup(warped, bridge_resolution, param.with_blend ? &mask : nullptr);
+		auto path = ofToDataPath(ofFilePath::join(folder, param.filename), true);
+		if(param.is_png) {
+			map.savePng(path);
+		}
+		else {
+			map.saveRaw(path+".uvmap", param.is_unorm16 ? UVMap::UNORM16 : UVMap::FLOAT32);
+		}
+	}
+}
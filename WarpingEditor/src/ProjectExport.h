@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ProjectFolder.h"
+#include "MeshData.h"
+#include <thread>
+#include <algorithm>
+
+// writes everything the export settings of proj ask for: the warp and blend meshes, the blend shader
+// params and the uv map if enabled. needs no GL context, so the GUI and the command line share it.
+// warp uv in texture pixels of tex_size, blend in bridge pixels; as GuiApp holds them.
+// num_threads is what the uv map may use, for callers exporting several projects at once.
+void exportProject(const ProjectFolder &proj, const WarpingData &warp, const BlendingData &blend,
+				   const glm::vec2 &tex_size, const glm::ivec2 &bridge_resolution,
+				   std::size_t num_threads=std::max(1u, std::thread::hardware_concurrency()));
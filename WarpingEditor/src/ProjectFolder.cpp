@@ -68,17 +68,29 @@ struct adl_serializer<ProjectFolder::Texture> {
 				j["type"] = "NDI";
 				j["arg"] = v.ndi;
 				break;
+			case ProjectFolder::Texture::SEQUENCE:
+				j["type"] = "Sequence";
+				j["arg"] = v.sequence;
+				break;
 		}
+		j["fps"] = v.fps;
 		j["size_cache"] = v.size_cache;
 	}
 	static void from_json(const ofJson &j, ProjectFolder::Texture &v) {
 		auto upper_type = ofToUpper(getJsonValue<std::string>(j, "type", "File"));
 		if(upper_type == "FILE") {
+			v.type = ProjectFolder::Texture::FILE;
 			updateByJsonValue(v.file, j, "arg");
 		}
 		else if(upper_type == "NDI") {
+			v.type = ProjectFolder::Texture::NDI;
 			updateByJsonValue(v.ndi, j, "arg");
 		}
+		else if(upper_type == "SEQUENCE") {
+			v.type = ProjectFolder::Texture::SEQUENCE;
+			updateByJsonValue(v.sequence, j, "arg");
+		}
+		updateByJsonValue(v.fps, j, "fps");
 		updateByJsonValue(v.size_cache, j, "size_cache");
 	}
 };
@@ -139,6 +151,25 @@ struct adl_serializer<ProjectFolder::Export::BlendShader> {
 		updateByJsonValue(v.filename, j, "filename");
 	}
 };
+template<>
+struct adl_serializer<ProjectFolder::Export::UVMap> {
+	static void to_json(ofJson &j, const ProjectFolder::Export::UVMap &v) {
+		j = {
+			{"enabled", v.enabled},
+			{"filename", v.filename},
+			{"png", v.is_png},
+			{"unorm16", v.is_unorm16},
+			{"with_blend", v.with_blend}
+		};
+	}
+	static void from_json(const ofJson &j, ProjectFolder::Export::UVMap &v) {
+		updateByJsonValue(v.enabled, j, "enabled");
+		updateByJsonValue(v.filename, j, "filename");
+		updateByJsonValue(v.is_png, j, "png");
+		updateByJsonValue(v.is_unorm16, j, "unorm16");
+		updateByJsonValue(v.with_blend, j, "with_blend");
+	}
+};
 
 template<>
 struct adl_serializer<ProjectFolder::Export> {
@@ -148,7 +179,8 @@ struct adl_serializer<ProjectFolder::Export> {
 			{"is_arb", v.is_arb},
 			{"warp", v.warp},
 			{"blend", v.blend},
-			{"blend_shader", v.blend_shader}
+			{"blend_shader", v.blend_shader},
+			{"uv_map", v.uv_map}
 		};
 	}
 	static void from_json(const ofJson &j, ProjectFolder::Export &v) {
@@ -157,6 +189,7 @@ struct adl_serializer<ProjectFolder::Export> {
 		updateByJsonValue(v.warp, j, "warp");
 		updateByJsonValue(v.blend, j, "blend");
 		updateByJsonValue(v.blend_shader, j, "blend_shader");
+		updateByJsonValue(v.uv_map, j, "uv_map");
 	}
 };
 template<>
@@ -275,16 +308,38 @@ void ProjectFolder::load() {
 	loadJson(ofLoadJson(getAbsolute(getProjFileName())));
 }
 void ProjectFolder::save() const {
-	ofSavePrettyJson(getAbsolute(getProjFileName()), toJson());
+	ofSavePrettyJson(getProjFilePath(), toJson());
+}
+std::string ProjectFolder::toJsonString() const {
+	return toJson().dump(4);
 }
 
-std::filesystem::path ProjectFolder::getBackupFilePath() const
+std::filesystem::path ProjectFolder::getBackupStorePath() const
 {
 	auto path = getDataFilePath();
 	auto folder = ofFilePath::join(ofFilePath::getEnclosingDirectory(path), backup_.folder);
-	auto basename = ofFilePath::getBaseName(path);
-	auto ext = ofFilePath::getFileExt(path);
-	return ofFilePath::join(folder, basename+"_"+ofGetTimestampString("%Y%m%d_%H%M%S"))+"."+ext;
+	return ofFilePath::join(folder, ofFilePath::getBaseName(path)+".backup");
+}
+
+std::vector<std::filesystem::path> ProjectFolder::getLegacyBackupFiles() const
+{
+	auto path = getDataFilePath();
+	ofDirectory folder(ofFilePath::join(ofFilePath::getEnclosingDirectory(path), backup_.folder));
+	if(!folder.exists()) {
+		return {};
+	}
+	auto prefix = ofFilePath::getBaseName(path)+"_";
+	folder.allowExt(ofFilePath::getFileExt(path));
+	folder.listDir();
+	// the timestamp in the name sorts them oldest first
+	folder.sort();
+	std::vector<std::filesystem::path> ret;
+	for(auto &&f : folder) {
+		if(f.getFileName().compare(0, prefix.size(), prefix) == 0) {
+			ret.push_back(f.getAbsolutePath());
+		}
+	}
+	return ret;
 }
 
 void ProjectFolder::setTextureSourceFile(const std::string &file_name)
@@ -297,4 +352,9 @@ void ProjectFolder::setTextureSourceNDI(const std::string &ndi_name)
 	texture_.type = Texture::NDI;
 	texture_.ndi = ndi_name;
 }
+void ProjectFolder::setTextureSourceSequence(const std::string &folder)
+{
+	texture_.type = Texture::SEQUENCE;
+	texture_.sequence = folder;
+}
 
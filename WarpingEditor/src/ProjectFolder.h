@@ -10,11 +10,13 @@ class ProjectFolder : public WorkFolder
 public:
 	struct Texture {
 		enum {
-			FILE, NDI
+			FILE, NDI, SEQUENCE
 		};
 		int type = FILE;
 		std::string file;
 		std::string ndi;
+		std::string sequence;
+		float fps=30;
 		glm::ivec2 size_cache;
 	};
 	struct Viewport {
@@ -31,6 +33,14 @@ public:
 		struct BlendShader {
 			std::string filename="blend_shader.json";
 		} blend_shader;
+		// per pixel lookup table of the warp(see UVMap.h)
+		struct UVMap {
+			bool enabled=false;
+			std::string filename="uv_map";
+			bool is_png=false;
+			bool is_unorm16=false;
+			bool with_blend=false;
+		} uv_map;
 	};
 	struct Backup {
 		bool enabled=true;
@@ -54,7 +64,10 @@ public:
 	void load();
 	void save() const;
 	void backup() const;
+	// the same text save() writes, for writing it elsewhere
+	std::string toJsonString() const;
 	
+	std::filesystem::path getProjFilePath() const { return getAbsolute(getProjFileName()); }
 	std::filesystem::path getDataFilePath() const { return getAbsolute(getDataFileName()+".maap"); }
 	std::string getDataFileName() const { return filename_; }
 	std::string getProjFileName() const { return "project.json"; }
@@ -62,6 +75,8 @@ public:
 	int getTextureType() const { return texture_.type; }
 	std::filesystem::path getTextureFilePath() const { return getAbsolute(texture_.file); }
 	const std::string& getTextureNDIName() const { return texture_.ndi; }
+	std::filesystem::path getTextureSequencePath() const { return getAbsolute(texture_.sequence); }
+	float getTextureSequenceFps() const { return texture_.fps; }
 	glm::ivec2 getTextureSizeCache() const { return texture_.size_cache; }
 
 	glm::vec4 getResultViewport() const { return viewport_.result; }
@@ -83,10 +98,13 @@ public:
 	Export::Mesh getExportWarpParam() const { return export_.warp; }
 	Export::Mesh getExportBlendParam() const { return export_.blend; }
 	Export::BlendShader getExportBlendShaderParam() const { return export_.blend_shader; }
+	Export::UVMap getExportUVMapParam() const { return export_.uv_map; }
 	
 	bool isBackupEnabled() const { return backup_.enabled; }
 	std::filesystem::path getBackupFolder() const { return getRelative(backup_.folder); }
-	std::filesystem::path getBackupFilePath() const;
+	std::filesystem::path getBackupStorePath() const;
+	// timestamped copies written by older versions
+	std::vector<std::filesystem::path> getLegacyBackupFiles() const;
 	int getBackupNumLimit() const { return backup_.limit; }
 	
 	EditorBase::GridData getUVGridData() const { return grid_.uv; }
@@ -95,6 +113,8 @@ public:
 	
 	void setTextureSourceFile(const std::string &file_name);
 	void setTextureSourceNDI(const std::string &ndi_name);
+	void setTextureSourceSequence(const std::string &folder);
+	void setTextureSequenceFps(float fps) { texture_.fps = fps; }
 	void setTextureSizeCache(const glm::vec2 size) { texture_.size_cache = size; }
 	
 	void setResultViewport(const glm::vec4 &viewport) { viewport_.result = viewport; }
@@ -116,6 +136,7 @@ public:
 	void setExportWarpParam(const Export::Mesh &param) { export_.warp = param; }
 	void setExportBlendParam(const Export::Mesh &param) { export_.blend = param; }
 	void setExportBlendShaderParam(const Export::BlendShader &param) { export_.blend_shader = param; }
+	void setExportUVMapParam(const Export::UVMap &param) { export_.uv_map = param; }
 
 	void setUVGridData(const EditorBase::GridData &data) { grid_.uv = data; }
 	void setWarpGridData(const EditorBase::GridData &data) { grid_.warp = data; }
@@ -0,0 +1,416 @@
+#include "CommandLine.h"
+#include "MeshData.h"
+#include "SaveData.h"
+#include "ProjectFolder.h"
+#include "ProjectExport.h"
+#include "ImageDiff.h"
+#include "BatchRenderer.h"
+#include "BlendFunction.h"
+#include "BlendShaderCheck.h"
+#include "ofAppGLFWWindow.h"
+#include "ofImage.h"
+#include "ofLog.h"
+#include <map>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+namespace {
+using Args = std::vector<std::string>;
+
+void printUsage() {
+	ofLogNotice("cli") << "usage:";
+	ofLogNotice("cli") << "  upgrade <src.maap> [dst.maap]  rewrite a data file in the latest format";
+	ofLogNotice("cli") << "  info <src.maap> [chunk...]     list chunks, and count meshes in the given ones";
+	ofLogNotice("cli") << "  compare <a> <b> [tolerance] [diff]";
+	ofLogNotice("cli") << "                                 check a render against a golden image, fails on mismatch";
+	ofLogNotice("cli") << "  render <project> <output> [input] [max_frames]";
+	ofLogNotice("cli") << "                                 warp and blend a video, still or folder of stills(default: the";
+	ofLogNotice("cli") << "                                 project's texture) into an image sequence per blending mesh";
+	ofLogNotice("cli") << "  bake-masks <project> <output>  write each blending mesh's gains as a 16 bit png";
+	ofLogNotice("cli") << "  check-blend <project> [blend_shader.json]";
+	ofLogNotice("cli") << "                                 check the exported shader params give the project's ramps";
+	ofLogNotice("cli") << "                                 (both through the CPU curve, the shader isn't run)";
+	ofLogNotice("cli") << "  check-shader <project> [tolerance]";
+	ofLogNotice("cli") << "                                 render the project's ramps with the shader in a hidden window";
+	ofLogNotice("cli") << "                                 and check the CPU curve matches them(tolerance in 65535ths, default: 1)";
+	ofLogNotice("cli") << "  export <project>...            export each project by its saved settings, in parallel";
+}
+
+bool openProject(const std::string &folder, ProjectFolder &proj) {
+	if(!proj.setAbsolute(std::filesystem::absolute(folder))) {
+		ofLogError("cli") << "not a folder: " << folder;
+		return false;
+	}
+	proj.load();
+	return true;
+}
+
+// warp uv in pixels of tex_size(normalized by default), blend in bridge pixels
+bool loadDataFile(const ProjectFolder &proj, std::shared_ptr<WarpingData> warp, std::shared_ptr<BlendingData> blend, const glm::vec2 &tex_size={1,1}) {
+	warp->setUnpackArg(tex_size);
+	blend->setUnpackArg(proj.getBridgeResolution());
+	// the data file's own params win, as when the GUI opens a project
+	blend->getShader()->getParams() = proj.getBlendParams();
+	SaveData data;
+	data.append((char *)"warp", warp);
+	data.append((char *)"blnd", blend);
+	if(!data.load(proj.getDataFilePath())) {
+		ofLogError("cli") << "failed to load: " << proj.getDataFilePath();
+		return false;
+	}
+	return true;
+}
+
+int upgrade(const Args &args) {
+	if(args.empty()) {
+		printUsage();
+		return 1;
+	}
+	std::filesystem::path src = args[0];
+	std::filesystem::path dst = args.size() > 1 ? args[1] : args[0];
+	auto warp = std::make_shared<WarpingData>();
+	auto blend = std::make_shared<BlendingData>(false);
+	// coordinates are stored normalized; unit scale keeps them as they are
+	warp->setUnpackArg({1,1});
+	warp->setPackArg({1,1});
+	blend->setUnpackArg({1,1});
+	blend->setPackArg({1,1});
+	SaveData data;
+	data.append((char *)"warp", warp);
+	data.append((char *)"blnd", blend);
+	if(!data.upgrade(src, dst)) {
+		ofLogError("cli") << "failed to upgrade: " << src;
+		return 1;
+	}
+	ofLogNotice("cli") << "upgraded: " << src << " -> " << dst;
+	return 0;
+}
+
+int info(const Args &args) {
+	if(args.empty()) {
+		printUsage();
+		return 1;
+	}
+	auto warp = std::make_shared<WarpingData>();
+	auto blend = std::make_shared<BlendingData>(false);
+	SaveData data;
+	data.append((char *)"warp", warp);
+	data.append((char *)"blnd", blend);
+	if(!data.open(args[0])) {
+		ofLogError("cli") << "failed to open: " << args[0];
+		return 1;
+	}
+	ofLogNotice("cli") << args[0] << " version " << data.getVersion();
+	for(auto &&c : data.getChunkList()) {
+		ofLogNotice("cli") << "  " << c.first << ": " << c.second << " bytes";
+	}
+	// only the chunks asked for are decoded
+	for(auto it = begin(args)+1; it != end(args); ++it) {
+		if(auto chunk = std::dynamic_pointer_cast<DataContainerBase>(data.get(*it))) {
+			std::size_t num = chunk == warp ? warp->getData().size() : blend->getData().size();
+			ofLogNotice("cli") << *it << ": " << num << " meshes";
+		}
+		else {
+			ofLogWarning("cli") << "no such chunk: " << *it;
+		}
+	}
+	return 0;
+}
+
+int compare(const Args &args) {
+	if(args.size() < 2) {
+		printUsage();
+		return 1;
+	}
+	ofPixels a, b;
+	if(!ofLoadImage(a, args[0]) || !ofLoadImage(b, args[1])) {
+		ofLogError("cli") << "failed to load: " << args[0] << ", " << args[1];
+		return 1;
+	}
+	int tolerance = args.size() > 2 ? ofToInt(args[2]) : 0;
+	ofPixels diff;
+	auto result = compareImages(a, b, tolerance, args.size() > 3 ? &diff : nullptr);
+	if(!result.is_same_shape) {
+		ofLogError("cli") << "shape differs: " << a.getWidth() << "x" << a.getHeight() << "x" << a.getNumChannels()
+		<< " vs " << b.getWidth() << "x" << b.getHeight() << "x" << b.getNumChannels();
+		return 1;
+	}
+	if(args.size() > 3) {
+		ofSaveImage(diff, args[3]);
+	}
+	ofLogNotice("cli") << result.num_mismatched << "/" << result.num_pixels << " pixels mismatched"
+	<< ", max error " << result.max_error << ", psnr " << result.psnr;
+	return result.isMatch() ? 0 : 1;
+}
+
+int render(const Args &args) {
+	if(args.size() < 2) {
+		printUsage();
+		return 1;
+	}
+	ProjectFolder proj;
+	if(!openProject(args[0], proj)) {
+		return 1;
+	}
+	BatchRenderer::Settings settings;
+	settings.output = std::filesystem::absolute(args[1]);
+	if(args.size() > 2) {
+		settings.input = std::filesystem::absolute(args[2]);
+	}
+	else {
+		switch(proj.getTextureType()) {
+			case ProjectFolder::Texture::FILE: settings.input = proj.getTextureFilePath(); break;
+			case ProjectFolder::Texture::SEQUENCE: settings.input = proj.getTextureSequencePath(); break;
+			default:
+				ofLogError("cli") << "the project's texture can't be rendered offline, give an input";
+				return 1;
+		}
+	}
+	if(args.size() > 3) {
+		settings.max_frames = std::max(0, ofToInt(args[3]));
+	}
+	auto warp = std::make_shared<WarpingData>();
+	auto blend = std::make_shared<BlendingData>(false);
+	if(!loadDataFile(proj, warp, blend)) {
+		return 1;
+	}
+	BatchRenderer renderer;
+	renderer.setup(warp, blend, proj.getBridgeResolution());
+	bool succeeded = renderer.run(settings);
+	auto stats = renderer.getStats();
+	ofLogNotice("cli") << stats.rendered << " frames rendered, " << stats.written << " images written"
+	<< (stats.failed > 0 ? ", "+ofToString(stats.failed)+" failed" : "");
+	return succeeded ? 0 : 1;
+}
+
+int bakeMasks(const Args &args) {
+	if(args.size() < 2) {
+		printUsage();
+		return 1;
+	}
+	ProjectFolder proj;
+	if(!openProject(args[0], proj)) {
+		return 1;
+	}
+	auto warp = std::make_shared<WarpingData>();
+	auto blend = std::make_shared<BlendingData>(false);
+	if(!loadDataFile(proj, warp, blend)) {
+		return 1;
+	}
+	ofDirectory dir(std::filesystem::absolute(args[1]).string());
+	if(!dir.exists() && !dir.create(true)) {
+		ofLogError("cli") << "failed to create: " << args[1];
+		return 1;
+	}
+	int failed = 0;
+	for(auto &&d : blend->getVisibleData()) {
+		// each mesh alone; where another covers it the projector still needs its own ramp
+		BlendMask mask;
+		mask.setup(*d.second, blend->getShader()->getParams(), proj.getBridgeResolution());
+		ofShortPixels pixels;
+		mask.getMask(pixels);
+		auto path = ofFilePath::join(dir.getAbsolutePath(), d.first+".png");
+		if(ofSaveImage(pixels, path)) {
+			ofLogNotice("cli") << "baked: " << path;
+		}
+		else {
+			ofLogError("cli") << "failed to write: " << path;
+			++failed;
+		}
+	}
+	return failed > 0 ? 1 : 0;
+}
+
+bool readBlendParams(const ofJson &json, blend::Params &params) {
+	auto read = [&json](const std::string &key, float *dst, std::size_t size) {
+		if(!json.contains(key)) {
+			return false;
+		}
+		auto &&value = json[key];
+		if(size == 1) {
+			if(!value.is_number()) return false;
+			dst[0] = value.get<float>();
+			return true;
+		}
+		if(!value.is_array() || value.size() < size) {
+			return false;
+		}
+		for(std::size_t i = 0; i < size; ++i) {
+			dst[i] = value[i].get<float>();
+		}
+		return true;
+	};
+	return read("gamma", &params.gamma[0], 3)
+	&& read("luminance_control", &params.luminance_control, 1)
+	&& read("blend_power", &params.blend_power, 1)
+	&& read("base_color", &params.base_color[0], 3);
+}
+
+int checkBlend(const Args &args) {
+	if(args.empty()) {
+		printUsage();
+		return 1;
+	}
+	ProjectFolder proj;
+	if(!openProject(args[0], proj)) {
+		return 1;
+	}
+	auto warp = std::make_shared<WarpingData>();
+	auto blend = std::make_shared<BlendingData>(false);
+	if(!loadDataFile(proj, warp, blend)) {
+		return 1;
+	}
+	auto path = args.size() > 1 ? std::filesystem::absolute(args[1])
+	: std::filesystem::path(ofToDataPath(ofFilePath::join(proj.getExportFolder(), proj.getExportBlendShaderParam().filename), true));
+	blend::Params exported;
+	if(!readBlendParams(ofLoadJson(path), exported)) {
+		ofLogError("cli") << "not a blend shader file: " << path;
+		return 1;
+	}
+	const auto &expected = blend->getShader()->getParams();
+	// ramps across an overlap and the corner where two overlaps cross, compared at 16 bit precision
+	const std::size_t n = 1025;
+	std::vector<float> x(n), one(n, 1), a(n*3), b(n*3);
+	for(std::size_t i = 0; i < n; ++i) {
+		x[i] = i/float(n-1);
+	}
+	int max_steps = 0;
+	auto compare = [&](const float *xs, const float *ys) {
+		blend::gain(xs, ys, n, expected, a.data());
+		blend::gain(xs, ys, n, exported, b.data());
+		for(std::size_t i = 0; i < n*3; ++i) {
+			max_steps = std::max(max_steps, (int)std::round(std::abs(a[i]-b[i])*65535));
+		}
+	};
+	compare(x.data(), one.data());
+	compare(x.data(), x.data());
+	for(int c = 0; c < 3; ++c) {
+		max_steps = std::max(max_steps, (int)std::round(std::abs(expected.base_color[c]-exported.base_color[c])*65535));
+	}
+	if(max_steps > 0) {
+		ofLogError("cli") << path << " differs from the project by up to " << max_steps << "/65535";
+		return 1;
+	}
+	ofLogNotice("cli") << path << " reproduces the project's blend";
+	return 0;
+}
+
+int checkShader(const Args &args) {
+	if(args.empty()) {
+		printUsage();
+		return 1;
+	}
+	ProjectFolder proj;
+	if(!openProject(args[0], proj)) {
+		return 1;
+	}
+	auto warp = std::make_shared<WarpingData>();
+	auto blend = std::make_shared<BlendingData>(false);
+	if(!loadDataFile(proj, warp, blend)) {
+		return 1;
+	}
+	int tolerance = args.size() > 1 ? std::max(0, ofToInt(args[1])) : 1;
+	// the shader needs a GL context; a window that is never shown gives one without running the app
+	ofGLFWWindowSettings settings;
+	settings.setGLVersion(4,1);
+	settings.setSize(1,1);
+	settings.visible = false;
+	ofCreateWindow(settings);
+	ofxBlendScreen::Shader shader;
+	shader.setup();
+	shader.getParams() = blend->getShader()->getParams();
+	auto result = checkBlendShader(shader);
+	if(!result.is_done) {
+		ofLogError("cli") << "failed to render the shader";
+		return 1;
+	}
+	if(!result.isMatch(tolerance)) {
+		ofLogError("cli") << "the shader differs from the CPU curve by " << result.max_steps << "/65535"
+		<< " at " << result.worst.x << "," << result.worst.y << " of " << result.size
+		<< ", gpu " << result.gpu << " cpu " << result.cpu;
+		return 1;
+	}
+	ofLogNotice("cli") << "the shader matches the CPU curve, max diff " << result.max_steps << "/65535";
+	return 0;
+}
+
+bool exportOne(const std::string &folder, std::size_t num_threads) {
+	ProjectFolder proj;
+	if(!openProject(folder, proj)) {
+		return false;
+	}
+	glm::vec2 tex_size = proj.getTextureSizeCache();
+	if(tex_size.x <= 0 || tex_size.y <= 0) {
+		// normalized uv are all a non-arb export needs
+		if(proj.getIsExportMeshArb()) {
+			ofLogWarning("cli") << folder << ": texture size unknown, arb uv are exported normalized";
+		}
+		tex_size = {1,1};
+	}
+	auto warp = std::make_shared<WarpingData>();
+	auto blend = std::make_shared<BlendingData>(false);
+	if(!loadDataFile(proj, warp, blend, tex_size)) {
+		return false;
+	}
+	exportProject(proj, *warp, *blend, tex_size, proj.getBridgeResolution(), num_threads);
+	ofLogNotice("cli") << "exported: " << folder;
+	return true;
+}
+
+int exportProjects(const Args &args) {
+	if(args.empty()) {
+		printUsage();
+		return 1;
+	}
+	// projects run side by side and share the cores between their uv maps
+	std::size_t num_cores = std::max(1u, std::thread::hardware_concurrency());
+	std::size_t num_threads = std::min<std::size_t>(args.size(), num_cores);
+	std::size_t threads_per_project = std::max<std::size_t>(1, num_cores/num_threads);
+	std::atomic<std::size_t> next{0}, failed{0};
+	auto work = [&]() {
+		std::size_t index;
+		while((index = next++) < args.size()) {
+			if(!exportOne(args[index], threads_per_project)) {
+				++failed;
+			}
+		}
+	};
+	std::vector<std::thread> threads;
+	for(std::size_t i = 1; i < num_threads; ++i) {
+		threads.emplace_back(work);
+	}
+	work();
+	for(auto &&t : threads) {
+		t.join();
+	}
+	if(failed > 0) {
+		ofLogError("cli") << failed << " of " << args.size() << " projects failed";
+		return 1;
+	}
+	return 0;
+}
+}
+
+bool cli::run(int argc, char *argv[], int &exit_code)
+{
+	std::map<std::string, std::function<int(const Args&)>> commands{
+		{"upgrade", upgrade},
+		{"info", info},
+		{"compare", compare},
+		{"render", render},
+		{"bake-masks", bakeMasks},
+		{"check-blend", checkBlend},
+		{"check-shader", checkShader},
+		{"export", exportProjects},
+	};
+	if(argc < 2) {
+		return false;
+	}
+	auto found = commands.find(argv[1]);
+	if(found == end(commands)) {
+		return false;
+	}
+	exit_code = found->second(Args(argv+2, argv+argc));
+	return true;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace cli {
+// runs a task without opening any window if argv names one.
+// returns false when there's nothing to do so the GUI should start.
+bool run(int argc, char *argv[], int &exit_code);
+}
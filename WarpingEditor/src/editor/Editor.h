@@ -48,6 +48,11 @@ public:
 	void setTexture(ofTexture tex) { tex_ = tex; }
 	ofTexture getTexture() const { return tex_; }
 	glm::vec2 getTextureResolution() const { return {tex_.getWidth(), tex_.getHeight()}; }
+	// the part of the work area currently inside the editor's region
+	ofRectangle getVisibleWorkArea() const {
+		auto viewport = getRegion();
+		return {getIn(viewport.getTopLeft()), getIn(viewport.getBottomRight())};
+	}
 	virtual glm::vec2 getWorkAreaSize() const { return {tex_.getWidth(), tex_.getHeight()}; }
 
 	void handleMouse(const ofxEditorFrame::MouseEventArg &arg) { mouse_.set(arg); }
@@ -164,6 +164,19 @@ void BlendingEditor::gui()
 			SliderFloat("luminance_control", &p.luminance_control, 0, 1);
 			SliderFloat3("gamma", &p.gamma[0], 0, 3);
 			ColorEdit3("base_color", &p.base_color[0]);
+			// renders, bakes and uv maps go through the CPU copy of the curve
+			if(Button("check against CPU")) {
+				shader_check_ = checkBlendShader(*data_->getShader());
+			}
+			if(shader_check_.is_done) {
+				SameLine();
+				if(shader_check_.isMatch()) {
+					Text("matches, max diff %d/65535", shader_check_.max_steps);
+				}
+				else {
+					Text("differs by %d/65535 at %d,%d of %d", shader_check_.max_steps, shader_check_.worst.x, shader_check_.worst.y, shader_check_.size);
+				}
+			}
 			TreePop();
 		}
 		if(BeginTabBar("#tab")) {
@@ -3,6 +3,7 @@
 #include "Editor.h"
 #include "ofxBlendScreen.h"
 #include "ofFbo.h"
+#include "BlendShaderCheck.h"
 
 class BlendingEditor : public Editor<BlendingMesh, BlendingMesh::MeshType, std::pair<int,int>>
 {
@@ -27,4 +28,5 @@ public:
 
 private:
 	std::vector<int> getEditableMeshIndex(int state);
+	BlendShaderCheck shader_check_;
 };
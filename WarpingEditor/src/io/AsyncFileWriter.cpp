@@ -0,0 +1,190 @@
+#include "AsyncFileWriter.h"
+#include "ofConstants.h"
+#include "ofLog.h"
+#include "ofUtils.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#endif
+
+namespace {
+std::filesystem::path getTempPath(const std::filesystem::path &filepath)
+{
+	auto ret = filepath;
+	ret += ".tmp";
+	return ret;
+}
+void setError(std::string *error, const std::string &message, const std::filesystem::path &filepath)
+{
+	if(error) {
+		*error = message + ": " + filepath.string();
+	}
+}
+}
+
+AsyncFileWriter::AsyncFileWriter()
+{
+	thread_ = std::thread(&AsyncFileWriter::threadedFunction, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+	// pending jobs are still written so that saving right before quitting is not lost
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		is_exiting_ = true;
+	}
+	job_cv_.notify_all();
+	if(thread_.joinable()) {
+		thread_.join();
+	}
+}
+
+void AsyncFileWriter::push(Job job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		jobs_.push_back(std::move(job));
+		status_.state = WRITING;
+		status_.num_pending = jobs_.size() + (is_busy_ ? 1 : 0);
+	}
+	job_cv_.notify_one();
+}
+
+void AsyncFileWriter::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	done_cv_.wait(lock, [this]{ return jobs_.empty() && !is_busy_; });
+}
+
+AsyncFileWriter::Status AsyncFileWriter::getStatus() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return status_;
+}
+
+void AsyncFileWriter::threadedFunction()
+{
+	while(true) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			job_cv_.wait(lock, [this]{ return is_exiting_ || !jobs_.empty(); });
+			if(jobs_.empty()) {
+				return;
+			}
+			job = std::move(jobs_.front());
+			jobs_.pop_front();
+			is_busy_ = true;
+		}
+		std::string error;
+		bool succeeded = true;
+		for(auto &&f : job.files) {
+			if(!writeAtomic(f.path, f.data.data(), f.data.size(), &error)) {
+				ofLogError("AsyncFileWriter") << error;
+				succeeded = false;
+				break;
+			}
+		}
+		// the job's follow-up (e.g. backup) only makes sense when the files are actually there
+		if(succeeded && job.after) {
+			job.after();
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			is_busy_ = false;
+			status_.num_pending = jobs_.size();
+			if(!succeeded) {
+				status_.state = FAILED;
+				status_.message = error;
+			}
+			else {
+				status_.state = jobs_.empty() ? SUCCEEDED : WRITING;
+				status_.message = "saved at " + ofGetTimestampString("%H:%M:%S");
+			}
+		}
+		done_cv_.notify_all();
+	}
+}
+
+bool AsyncFileWriter::writeAtomic(const std::filesystem::path &filepath, const char *data, std::size_t size, std::string *error)
+{
+	auto temp_path = getTempPath(filepath);
+#ifdef TARGET_WIN32
+	HANDLE file = CreateFileW(temp_path.wstring().c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE) {
+		setError(error, "failed to create", temp_path);
+		return false;
+	}
+	while(size > 0) {
+		DWORD chunk = size > (1u<<30) ? (1u<<30) : static_cast<DWORD>(size);
+		DWORD written = 0;
+		if(!WriteFile(file, data, chunk, &written, nullptr)) {
+			CloseHandle(file);
+			DeleteFileW(temp_path.wstring().c_str());
+			setError(error, "failed to write", temp_path);
+			return false;
+		}
+		data += written;
+		size -= written;
+	}
+	bool flushed = FlushFileBuffers(file);
+	CloseHandle(file);
+	if(!flushed) {
+		DeleteFileW(temp_path.wstring().c_str());
+		setError(error, "failed to flush", temp_path);
+		return false;
+	}
+	if(!MoveFileExW(temp_path.wstring().c_str(), filepath.wstring().c_str(), MOVEFILE_REPLACE_EXISTING|MOVEFILE_WRITE_THROUGH)) {
+		DeleteFileW(temp_path.wstring().c_str());
+		setError(error, "failed to replace", filepath);
+		return false;
+	}
+#else
+	int fd = ::open(temp_path.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if(fd < 0) {
+		setError(error, std::string("failed to create (")+strerror(errno)+")", temp_path);
+		return false;
+	}
+	while(size > 0) {
+		ssize_t written = ::write(fd, data, size);
+		if(written < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			setError(error, std::string("failed to write (")+strerror(errno)+")", temp_path);
+			::close(fd);
+			::unlink(temp_path.c_str());
+			return false;
+		}
+		data += written;
+		size -= written;
+	}
+	if(::fsync(fd) != 0) {
+		setError(error, std::string("failed to sync (")+strerror(errno)+")", temp_path);
+		::close(fd);
+		::unlink(temp_path.c_str());
+		return false;
+	}
+	::close(fd);
+	if(std::rename(temp_path.c_str(), filepath.c_str()) != 0) {
+		setError(error, std::string("failed to replace (")+strerror(errno)+")", filepath);
+		::unlink(temp_path.c_str());
+		return false;
+	}
+	// the rename itself lives in the directory entry
+	auto folder = filepath.parent_path();
+	int dir = ::open(folder.empty() ? "." : folder.c_str(), O_RDONLY);
+	if(dir >= 0) {
+		::fsync(dir);
+		::close(dir);
+	}
+#endif
+	return true;
+}
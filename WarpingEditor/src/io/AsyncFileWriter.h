@@ -0,0 +1,60 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// writes snapshots of files on a worker thread.
+// each file goes to a temporary sibling first, gets fsync'ed and is then renamed over the target,
+// so a crash at any point leaves either the old or the new file but never a half written one.
+class AsyncFileWriter
+{
+public:
+	struct File {
+		std::filesystem::path path;
+		std::vector<char> data;
+	};
+	struct Job {
+		std::vector<File> files;
+		// runs on the worker after every file in the job is in place
+		std::function<void()> after;
+	};
+	enum State {
+		IDLE,
+		WRITING,
+		SUCCEEDED,
+		FAILED
+	};
+	struct Status {
+		State state=IDLE;
+		std::size_t num_pending=0;
+		std::string message;
+	};
+
+	AsyncFileWriter();
+	~AsyncFileWriter();
+	AsyncFileWriter(const AsyncFileWriter&) = delete;
+	AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+	void push(Job job);
+	// blocks until every pushed job has been written
+	void wait();
+	Status getStatus() const;
+
+	static bool writeAtomic(const std::filesystem::path &filepath, const char *data, std::size_t size, std::string *error=nullptr);
+private:
+	void threadedFunction();
+
+	std::thread thread_;
+	mutable std::mutex mutex_;
+	std::condition_variable job_cv_, done_cv_;
+	std::deque<Job> jobs_;
+	bool is_busy_=false;
+	bool is_exiting_=false;
+	Status status_;
+};
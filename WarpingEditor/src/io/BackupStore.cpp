@@ -0,0 +1,263 @@
+#include "BackupStore.h"
+#include "AsyncFileWriter.h"
+#include "MappedFile.h"
+#include "ofJson.h"
+#include "ofLog.h"
+#include <set>
+#include <algorithm>
+
+namespace {
+const int INDEX_VERSION = 1;
+std::string getIndexFileName() { return "index.json"; }
+// the old backups were named <name>_%Y%m%d_%H%M%S
+std::string getTimestamp(const std::string &stem)
+{
+	const std::size_t length = 15;
+	return stem.size() > length && stem[stem.size()-length-1] == '_' ? stem.substr(stem.size()-length) : stem;
+}
+std::string getHashOf(const std::string &id)
+{
+	return id.substr(0, id.find('-'));
+}
+bool isSame(const std::filesystem::path &path, const char *data, std::size_t size)
+{
+	MappedFile file(path);
+	return file.isOpen() && file.size() == size && std::equal(data, data+size, file.data());
+}
+}
+
+std::string BackupStore::hash(const char *data, std::size_t size)
+{
+	// FNV-1a; only has to spread pieces of one project, the bytes are compared before sharing one
+	std::uint64_t h = 0xcbf29ce484222325ULL;
+	for(std::size_t i = 0; i < size; ++i) {
+		h ^= static_cast<std::uint8_t>(data[i]);
+		h *= 0x100000001b3ULL;
+	}
+	char buf[17];
+	snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+	return buf;
+}
+
+bool BackupStore::setup(const std::filesystem::path &folder)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	folder_ = folder;
+	points_.clear();
+	std::error_code ec;
+	std::filesystem::create_directories(folder_/"objects", ec);
+	if(ec) {
+		ofLogError("BackupStore") << "failed to create folder: " << folder_;
+		return false;
+	}
+	return loadIndex();
+}
+
+std::filesystem::path BackupStore::getPiecePath(const std::string &id) const
+{
+	return folder_/"objects"/id.substr(0,2)/id;
+}
+
+bool BackupStore::writePiece(const char *data, std::size_t size, std::string &id) const
+{
+	const std::string h = hash(data, size);
+	std::filesystem::path path;
+	std::error_code ec;
+	for(int n = 0;; ++n) {
+		id = n == 0 ? h : h+"-"+std::to_string(n);
+		path = getPiecePath(id);
+		if(!std::filesystem::exists(path, ec)) {
+			break;
+		}
+		if(isSame(path, data, size)) {
+			return true;
+		}
+	}
+	std::filesystem::create_directories(path.parent_path(), ec);
+	std::string error;
+	if(!AsyncFileWriter::writeAtomic(path, data, size, &error)) {
+		ofLogError("BackupStore") << error;
+		return false;
+	}
+	return true;
+}
+
+bool BackupStore::add(const std::string &label, const char *data, std::size_t size, const std::vector<std::size_t> &split_points)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Point point;
+	point.label = label;
+	point.size = size;
+	std::size_t offset = 0;
+	auto addPiece = [&](std::size_t end) {
+		if(end <= offset || end > size) {
+			return true;
+		}
+		std::string id;
+		if(!writePiece(data+offset, end-offset, id)) {
+			return false;
+		}
+		point.pieces.push_back(id);
+		offset = end;
+		return true;
+	};
+	for(auto &&s : split_points) {
+		if(!addPiece(s)) {
+			return false;
+		}
+	}
+	if(!addPiece(size)) {
+		return false;
+	}
+	// pieces are in place before the index refers to them, so a crash only leaves unreferenced pieces.
+	// labels are timestamps, so imported points find their place among the newer ones
+	auto pos = std::upper_bound(begin(points_), end(points_), point, [](const Point &a, const Point &b) {
+		return a.label < b.label;
+	});
+	points_.insert(pos, point);
+	return saveIndex();
+}
+
+void BackupStore::prune(std::size_t limit)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if(limit == 0 || points_.size() <= limit) {
+		return;
+	}
+	std::vector<Point> removed(begin(points_), end(points_)-limit);
+	points_.erase(begin(points_), end(points_)-limit);
+	if(!saveIndex()) {
+		return;
+	}
+	std::set<std::string> alive;
+	for(auto &&p : points_) {
+		alive.insert(begin(p.pieces), end(p.pieces));
+	}
+	std::error_code ec;
+	for(auto &&p : removed) {
+		for(auto &&h : p.pieces) {
+			if(alive.insert(h).second) {
+				std::filesystem::remove(getPiecePath(h), ec);
+			}
+		}
+	}
+	// imported files go with their point, unless a kept point has the same timestamp
+	std::set<std::string> labels;
+	for(auto &&p : removed) {
+		labels.insert(p.label);
+	}
+	for(auto &&p : points_) {
+		labels.erase(p.label);
+	}
+	std::vector<std::filesystem::path> legacy;
+	for(auto &&entry : std::filesystem::directory_iterator(folder_/"legacy", ec)) {
+		if(labels.count(getTimestamp(entry.path().stem().string())) > 0) {
+			legacy.push_back(entry.path());
+		}
+	}
+	for(auto &&f : legacy) {
+		std::filesystem::remove(f, ec);
+	}
+}
+
+void BackupStore::importFiles(const std::vector<std::filesystem::path> &files)
+{
+	std::error_code ec;
+	auto legacy = folder_/"legacy";
+	std::filesystem::create_directories(legacy, ec);
+	for(auto &&f : files) {
+		bool imported;
+		{
+			MappedFile file(f);
+			if(!file.isOpen()) {
+				continue;
+			}
+			imported = add(getTimestamp(f.stem().string()), file.data(), file.size(), {});
+		}
+		// kept, only moved out of the way so they aren't imported again
+		if(imported) {
+			std::filesystem::rename(f, legacy/f.filename(), ec);
+			if(ec) {
+				ofLogWarning("BackupStore") << "failed to move imported backup: " << f;
+			}
+		}
+	}
+}
+
+std::vector<BackupStore::Point> BackupStore::getPoints() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return points_;
+}
+
+bool BackupStore::restore(std::size_t index, std::vector<char> &dst) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if(index >= points_.size()) {
+		return false;
+	}
+	auto &&point = points_[index];
+	dst.clear();
+	dst.reserve(point.size);
+	for(auto &&h : point.pieces) {
+		MappedFile file(getPiecePath(h));
+		if(!file.isOpen() || hash(file.data(), file.size()) != getHashOf(h)) {
+			ofLogError("BackupStore") << "missing or broken piece: " << h;
+			return false;
+		}
+		dst.insert(end(dst), file.data(), file.data()+file.size());
+	}
+	if(dst.size() != point.size) {
+		ofLogError("BackupStore") << "size mismatch: " << point.label;
+		return false;
+	}
+	return true;
+}
+
+bool BackupStore::loadIndex()
+{
+	auto path = folder_/getIndexFileName();
+	std::error_code ec;
+	if(!std::filesystem::exists(path, ec)) {
+		return true;
+	}
+	MappedFile file(path);
+	if(!file.isOpen()) {
+		return false;
+	}
+	auto json = ofJson::parse(file.data(), file.data()+file.size(), nullptr, false);
+	if(json.is_discarded() || !json.contains("points")) {
+		ofLogError("BackupStore") << "broken index: " << path;
+		return false;
+	}
+	for(auto &&p : json["points"]) {
+		Point point;
+		point.label = p.value("label", "");
+		point.size = p.value<std::uint64_t>("size", 0);
+		point.pieces = p.value("pieces", std::vector<std::string>{});
+		points_.push_back(point);
+	}
+	return true;
+}
+
+bool BackupStore::saveIndex() const
+{
+	ofJson points = ofJson::array();
+	for(auto &&p : points_) {
+		points.push_back({
+			{"label", p.label},
+			{"size", p.size},
+			{"pieces", p.pieces}
+		});
+	}
+	auto text = ofJson{
+		{"version", INDEX_VERSION},
+		{"points", points}
+	}.dump(1);
+	std::string error;
+	if(!AsyncFileWriter::writeAtomic(folder_/getIndexFileName(), text.data(), text.size(), &error)) {
+		ofLogError("BackupStore") << error;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+// content addressed storage for backups of a data file.
+// a file is cut into pieces at the given split points(e.g. one piece per mesh record),
+// each piece is stored once under its hash and a backup point is just the list of hashes.
+// pieces are compared byte by byte before one is shared; on a hash collision the newcomer is stored as <hash>-<n>.
+// saving again after editing one mesh only writes that mesh's piece.
+//
+// layout:	<folder>/index.json			backup points, oldest first
+//			<folder>/objects/xx/<hash>	pieces, xx is the first two digits of the hash
+//			<folder>/legacy/			whole-file backups of the old layout, after importing them, until their point is pruned
+class BackupStore
+{
+public:
+	struct Point {
+		std::string label;
+		std::uint64_t size;
+		std::vector<std::string> pieces;
+	};
+	bool setup(const std::filesystem::path &folder);
+	const std::filesystem::path& getFolder() const { return folder_; }
+
+	bool add(const std::string &label, const char *data, std::size_t size, const std::vector<std::size_t> &split_points);
+	// keeps only the newest `limit` points and removes pieces nobody refers to anymore,
+	// and the legacy files the removed points were imported from. 0 means unlimited.
+	void prune(std::size_t limit);
+	// copies whole-file backups of the old layout into the store and moves the files to <folder>/legacy
+	void importFiles(const std::vector<std::filesystem::path> &files);
+
+	std::vector<Point> getPoints() const;
+	bool restore(std::size_t index, std::vector<char> &dst) const;
+
+	static std::string hash(const char *data, std::size_t size);
+private:
+	std::filesystem::path folder_;
+	std::vector<Point> points_;
+	mutable std::mutex mutex_;
+
+	std::filesystem::path getPiecePath(const std::string &id) const;
+	// id is the hash, with a number appended if another piece already has that hash
+	bool writePiece(const char *data, std::size_t size, std::string &id) const;
+	bool loadIndex();
+	bool saveIndex() const;
+};
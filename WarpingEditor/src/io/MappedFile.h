@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ofConstants.h"
+#include <filesystem>
+#include <istream>
+#include <streambuf>
+#include <cstddef>
+
+// read-only memory mapping of a whole file.
+// pages are faulted in by the OS on first touch, nothing is copied.
+class MappedFile
+{
+public:
+	MappedFile(){}
+	MappedFile(const std::filesystem::path &filepath) { open(filepath); }
+	~MappedFile() { close(); }
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::filesystem::path &filepath);
+	void close();
+	bool isOpen() const { return is_open_; }
+	const char* data() const { return data_; }
+	std::size_t size() const { return size_; }
+private:
+	bool is_open_=false;
+	const char *data_=nullptr;
+	std::size_t size_=0;
+#ifdef TARGET_WIN32
+	void *file_=nullptr;
+	void *mapping_=nullptr;
+#endif
+};
+
+// std::istream over a fixed range of bytes without copying them.
+// reading past the end sets eof/fail just like a file stream does.
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+	MemoryStreamBuf(const char *data, std::size_t size) {
+		char *p = const_cast<char*>(data);
+		setg(p, p, p+size);
+	}
+protected:
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which=std::ios_base::in) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which=std::ios_base::in) override {
+		return seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+};
+
+class MemoryStream : public std::istream
+{
+public:
+	MemoryStream(const char *data, std::size_t size)
+	:std::istream(nullptr)
+	,buf_(data, size) {
+		rdbuf(&buf_);
+	}
+private:
+	MemoryStreamBuf buf_;
+};
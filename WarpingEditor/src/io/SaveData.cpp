@@ -22,6 +22,15 @@ void readFrom<glm::vec3>(std::istream &is, glm::vec3 &t) {
 	readFrom(is, t[1]);
 	readFrom(is, t[2]);
 }
+template<typename T>
+bool readFrom(const char *data, std::size_t size, std::size_t &pos, T &t) {
+	if(size < pos || size-pos < sizeof(T)) {
+		return false;
+	}
+	memcpy(&t, data+pos, sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
 template<>
 void writeTo<ofxBlendScreen::Shader::Params>(std::ostream &os, const ofxBlendScreen::Shader::Params &t) {
 	writeTo(os, t.gamma);
@@ -47,55 +56,244 @@ void SaveData::unpack<ofxBlendScreen::Shader::Params>(std::istream &stream, ofxB
 {
 	readFrom(stream, t);
 }
+template<>
+void SaveData::pack<ofxBlendScreen::Shader::Params>(ByteWriter &writer, const ofxBlendScreen::Shader::Params &t)
+{
+	float values[8] = {
+		t.gamma[0], t.gamma[1], t.gamma[2],
+		t.luminance_control, t.blend_power,
+		t.base_color[0], t.base_color[1], t.base_color[2]
+	};
+	writer.putArray(values, 8);
+}
+template<>
+void SaveData::unpack<ofxBlendScreen::Shader::Params>(ByteReader &reader, ofxBlendScreen::Shader::Params &t)
+{
+	float values[8];
+	if(!reader.getArray(values, 8)) {
+		return;
+	}
+	t.gamma = {values[0], values[1], values[2]};
+	t.luminance_control = values[3];
+	t.blend_power = values[4];
+	t.base_color = {values[5], values[6], values[7]};
+}
+
+namespace {
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+const std::size_t DIRECTORY_ENTRY_SIZE = 24;
+const std::size_t CHUNK_ALIGNMENT = 16;
+}
 
 void SaveData::pack(std::ostream &stream) const
+{
+	ByteWriter writer;
+	pack(writer);
+	stream.write(writer.data(), writer.size());
+}
+
+void SaveData::pack(ByteWriter &writer) const
 {
 	// header
-	stream << "maap";
-	writeTo<std::size_t>(stream, 1);	// version number
+	writer.putBytes("maap", 4);
+	writer.put<std::uint64_t>(VERSION);
+	writer.put<std::uint32_t>(BYTE_ORDER_MARK);
+	writer.put<std::uint32_t>(data_.size());
+	auto pos_to_write_directory = writer.size();
+	writer.put<std::uint64_t>(0);	// placeholder for directory offset
+	writer.put<std::uint32_t>(0);
 
+	// directory
+	auto directory_offset = writer.size();
+	writer.patch<std::uint64_t>(pos_to_write_directory, directory_offset);
 	for(auto &&d : data_) {
-		stream << d.first;
-		auto pos_to_write_chunksize = stream.tellp();
-		writeTo<std::size_t>(stream, 0);	// placeholder for chunksize
-		auto begin_chunksize = stream.tellp();
-		d.second->pack(stream);
-		auto end_pos = stream.tellp();
-		auto chunksize = end_pos - begin_chunksize;
-		stream.seekp(pos_to_write_chunksize, std::ios_base::beg);
-		writeTo(stream, chunksize);
-		stream.seekp(end_pos, std::ios_base::beg);
+		writer.putBytes(d.first.c_str(), 4);
+		writer.put<std::uint32_t>(0);
+		writer.put<std::uint64_t>(0);	// placeholder for offset
+		writer.put<std::uint64_t>(0);	// placeholder for size
+	}
+
+	for(std::size_t i = 0; i < data_.size(); ++i) {
+		writer.align(CHUNK_ALIGNMENT);
+		auto begin_pos = writer.size();
+		writer.mark();
+		data_[i].second->pack(writer);
+		auto entry_pos = directory_offset + i*DIRECTORY_ENTRY_SIZE;
+		writer.patch<std::uint64_t>(entry_pos+8, begin_pos);
+		writer.patch<std::uint64_t>(entry_pos+16, writer.size()-begin_pos);
 	}
 }
 
 void SaveData::unpack(std::istream &stream)
 {
+	std::string buf{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+	unpack(buf.data(), buf.size());
+}
+
+std::shared_ptr<HasSaveData> SaveData::findHandler(const char chunkname[4]) const
+{
+	auto found = find_if(begin(data_), end(data_), [chunkname](const std::pair<std::string, std::shared_ptr<HasSaveData>> &p) {
+		return strncmp(chunkname, p.first.c_str(), 4) == 0;
+	});
+	if(found == end(data_)) {
+		ofLogWarning("SaveData") << "skipped unhandled chunk: " << std::string(chunkname, 4);
+		return nullptr;
+	}
+	return found->second;
+}
+
+bool SaveData::unpack(const char *data, std::size_t size)
+{
+	std::uint64_t version;
+	std::vector<Chunk> chunks;
+	if(!readTableOfContents(data, size, version, chunks)) {
+		return false;
+	}
+	for(auto &&c : chunks) {
+		if(auto handler = findHandler(c.name.c_str())) {
+			decode(*handler, version, data+c.offset, c.size);
+		}
+	}
+	return true;
+}
+
+void SaveData::decode(HasSaveData &handler, std::uint64_t version, const char *data, std::size_t size)
+{
+	// the handler only sees its own chunk so it can't run into the next one
+	switch(version) {
+		case 1: {
+			MemoryStream stream(data, size);
+			handler.unpack(stream);
+		}	break;
+		case 2: {
+			ByteReader reader(data, size);
+			handler.unpack(reader);
+		}	break;
+	}
+}
+
+bool SaveData::readTableOfContents(const char *data, std::size_t size, std::uint64_t &version, std::vector<Chunk> &chunks)
+{
+	std::size_t pos = 0;
 	// header
 	char maap[4];
-	readFrom(stream, maap);
-	assert(strncmp(maap, "maap", 4) == 0);
-	std::size_t version;
-	readFrom(stream, version);
-	
-	while(stream.good()) {
+	if(!readFrom(data, size, pos, maap) || strncmp(maap, "maap", 4) != 0
+	   || !readFrom(data, size, pos, version)) {
+		ofLogError("SaveData") << "not a maap data";
+		return false;
+	}
+	switch(version) {
+		case 1: return readTableOfContentsV1(data, size, pos, chunks);
+		case 2: return readTableOfContentsV2(data, size, pos, chunks);
+	}
+	ofLogError("SaveData") << "unsupported version: " << version;
+	return false;
+}
+
+bool SaveData::readTableOfContentsV1(const char *data, std::size_t size, std::size_t pos, std::vector<Chunk> &chunks)
+{
+	while(pos < size) {
 		char chunkname[4];
 		std::size_t chunksize;
-		readFrom(stream, chunkname);
-		readFrom(stream, chunksize);
-		if(stream.eof() || stream.fail()) {
-			break;
+		if(!readFrom(data, size, pos, chunkname)
+		   || !readFrom(data, size, pos, chunksize)
+		   || size-pos < chunksize) {
+			ofLogError("SaveData") << "broken chunk at " << pos;
+			return false;
 		}
-		auto next_pos = std::size_t(stream.tellg()) + chunksize;
-		auto found = find_if(begin(data_), end(data_), [chunkname](const std::pair<std::string, std::shared_ptr<HasSaveData>> &p) {
-			return strncmp(chunkname, p.first.c_str(), 4) == 0;
-		});
-		if(found == end(data_)) {
-			ofLogWarning("SaveData") << "skipped unhandled chunk: " << chunkname;
+		chunks.push_back({std::string(chunkname, 4), pos, chunksize});
+		pos += chunksize;
+	}
+	return true;
+}
+
+bool SaveData::readTableOfContentsV2(const char *data, std::size_t size, std::size_t pos, std::vector<Chunk> &chunks)
+{
+	ByteReader reader(data, size);
+	std::uint32_t byte_order_mark, num_chunks, reserved;
+	std::uint64_t directory_offset;
+	if(!reader.seek(pos)
+	   || !reader.get(byte_order_mark)
+	   || !reader.get(num_chunks)
+	   || !reader.get(directory_offset)
+	   || !reader.get(reserved)) {
+		ofLogError("SaveData") << "broken header";
+		return false;
+	}
+	if(byte_order_mark != BYTE_ORDER_MARK) {
+		ofLogError("SaveData") << "unknown byte order";
+		return false;
+	}
+	if(!reader.seek(directory_offset)) {
+		ofLogError("SaveData") << "broken directory";
+		return false;
+	}
+	for(std::uint32_t i = 0; i < num_chunks; ++i) {
+		char chunkname[4];
+		std::uint64_t offset, chunksize;
+		if(!reader.getBytes(chunkname, 4)
+		   || !reader.get(reserved)
+		   || !reader.get(offset)
+		   || !reader.get(chunksize)) {
+			ofLogError("SaveData") << "broken directory";
+			return false;
 		}
-		else {
-			found->second->unpack(stream);
+		if(offset > size || size-offset < chunksize) {
+			ofLogError("SaveData") << "broken chunk: " << std::string(chunkname, 4);
+			return false;
 		}
-		stream.seekg(next_pos, std::ios_base::beg);
+		chunks.push_back({std::string(chunkname, 4), offset, chunksize});
 	}
+	return true;
 }
 
+bool SaveData::open(const std::filesystem::path &filepath)
+{
+	close();
+	auto file = std::make_shared<MappedFile>(filepath);
+	if(!file->isOpen() || !readTableOfContents(file->data(), file->size(), version_, toc_)) {
+		toc_.clear();
+		return false;
+	}
+	file_ = file;
+	return true;
+}
+
+void SaveData::close()
+{
+	file_.reset();
+	toc_.clear();
+	version_ = 0;
+}
+
+std::vector<std::pair<std::string, std::size_t>> SaveData::getChunkList() const
+{
+	std::vector<std::pair<std::string, std::size_t>> ret;
+	for(auto &&c : toc_) {
+		ret.push_back({c.name, c.size});
+	}
+	return ret;
+}
+
+bool SaveData::hasChunk(const std::string &chunk_name) const
+{
+	return any_of(begin(toc_), end(toc_), [chunk_name](const Chunk &c) {
+		return c.name == chunk_name;
+	});
+}
+
+std::shared_ptr<HasSaveData> SaveData::get(const std::string &chunk_name)
+{
+	auto found = find_if(begin(toc_), end(toc_), [chunk_name](const Chunk &c) {
+		return c.name == chunk_name;
+	});
+	if(found == end(toc_)) {
+		return nullptr;
+	}
+	auto handler = findHandler(found->name.c_str());
+	if(handler && !found->is_decoded) {
+		decode(*handler, version_, file_->data()+found->offset, found->size);
+		found->is_decoded = true;
+	}
+	return handler;
+}
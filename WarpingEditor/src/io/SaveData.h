@@ -5,12 +5,17 @@
 #include <filesystem>
 #include "ofFileUtils.h"
 #include "ofxBlendScreen.h"
+#include "MappedFile.h"
+#include "Bytes.h"
 
+// stream versions read/write the v1 layout, ByteWriter/ByteReader versions the v2 layout.
 class HasSaveData
 {
 public:
 	virtual void pack(std::ostream &stream) const {}
 	virtual void unpack(std::istream &stream) {}
+	virtual void pack(ByteWriter &writer) const {}
+	virtual void unpack(ByteReader &reader) {}
 };
 
 template<typename Arg>
@@ -19,17 +24,31 @@ class HasSaveDataWithArg : public HasSaveData
 public:
 	void pack(std::ostream &stream) const { pack(stream, pack_arg_); }
 	void unpack(std::istream &stream) { unpack(stream, unpack_arg_); }
+	void pack(ByteWriter &writer) const { pack(writer, pack_arg_); }
+	void unpack(ByteReader &reader) { unpack(reader, unpack_arg_); }
 	virtual void pack(std::ostream &stream, const Arg &arg) const {}
 	virtual void unpack(std::istream &stream, const Arg &arg) {}
+	virtual void pack(ByteWriter &writer, const Arg &arg) const {}
+	virtual void unpack(ByteReader &reader, const Arg &arg) {}
 	void setPackArg(const Arg &arg) { pack_arg_ = arg; }
 	void setUnpackArg(const Arg &arg) { unpack_arg_ = arg; }
 protected:
 	Arg pack_arg_, unpack_arg_;
 };
 
+/*
+ v1:	"maap", size_t version(=1)
+		then for each chunk: char name[4], size_t chunksize, data...
+ v2:	"maap", uint64 version(=2), uint32 byte order mark(0x01020304), uint32 num_chunks,
+		uint64 directory offset, uint32 reserved
+		directory: for each chunk: char name[4], uint32 reserved, uint64 offset, uint64 size
+		chunk data starts at 16 byte aligned offsets.
+		all values are little endian, arrays are 16 byte aligned so they can be copied in bulk.
+ */
 class SaveData
 {
 public:
+	static constexpr std::uint64_t VERSION = 2;
 	void append(char chunk_name[4], std::shared_ptr<HasSaveData> data) {
 		data_.push_back({std::string(chunk_name), data});
 	}
@@ -37,23 +56,66 @@ public:
 		data_.clear();
 	}
 	void save(const std::filesystem::path &filepath) const {
+		ByteWriter writer;
+		pack(writer);
 		ofFile file(filepath, ofFile::WriteOnly);
-		pack(file);
+		file.write(writer.data(), writer.size());
 		file.close();
 	}
-	void load(const std::filesystem::path &filepath) {
-		ofFile file(filepath, ofFile::ReadOnly);
-		unpack(file);
-		file.close();
+	bool load(const std::filesystem::path &filepath) {
+		MappedFile file(filepath);
+		return file.isOpen() && unpack(file.data(), file.size());
+	}
+	// loads src in any supported version and writes it to dst in the latest layout
+	bool upgrade(const std::filesystem::path &src, const std::filesystem::path &dst) {
+		if(!load(src)) {
+			return false;
+		}
+		save(dst);
+		return true;
 	}
 	void pack(std::ostream &stream) const;
+	void pack(ByteWriter &writer) const;
 	void unpack(std::istream &stream);
+	// parses chunks straight from a memory block(e.g. a mapped file).
+	// returns false if the header is wrong or a chunk runs past the end.
+	bool unpack(const char *data, std::size_t size);
+
+	// table of contents mode.
+	// open() only indexes the chunks by name and offset; each one is decoded into its handler on first get().
+	// chunks that are never asked for are never paged in from the file.
+	bool open(const std::filesystem::path &filepath);
+	void close();
+	bool isOpen() const { return file_ != nullptr; }
+	std::uint64_t getVersion() const { return version_; }
+	std::vector<std::pair<std::string, std::size_t>> getChunkList() const;
+	bool hasChunk(const std::string &chunk_name) const;
+	std::shared_ptr<HasSaveData> get(const std::string &chunk_name);
 	
 	template<typename T> static void pack(std::ostream &stream, const T &t);
 	template<typename T> static void unpack(std::istream &stream, T &t);
+	template<typename T> static void pack(ByteWriter &writer, const T &t);
+	template<typename T> static void unpack(ByteReader &reader, T &t);
 private:
 	std::vector<std::pair<std::string, std::shared_ptr<HasSaveData>>> data_;
+	std::shared_ptr<HasSaveData> findHandler(const char chunkname[4]) const;
+
+	struct Chunk {
+		std::string name;
+		std::size_t offset, size;
+		bool is_decoded=false;
+	};
+	static bool readTableOfContents(const char *data, std::size_t size, std::uint64_t &version, std::vector<Chunk> &chunks);
+	static bool readTableOfContentsV1(const char *data, std::size_t size, std::size_t pos, std::vector<Chunk> &chunks);
+	static bool readTableOfContentsV2(const char *data, std::size_t size, std::size_t pos, std::vector<Chunk> &chunks);
+	static void decode(HasSaveData &handler, std::uint64_t version, const char *data, std::size_t size);
+
+	std::shared_ptr<MappedFile> file_;
+	std::uint64_t version_=0;
+	std::vector<Chunk> toc_;
 };
 
 template<> void SaveData::pack<ofxBlendScreen::Shader::Params>(std::ostream &stream, const ofxBlendScreen::Shader::Params &t);
 template<> void SaveData::unpack<ofxBlendScreen::Shader::Params>(std::istream &stream, ofxBlendScreen::Shader::Params &t);
+template<> void SaveData::pack<ofxBlendScreen::Shader::Params>(ByteWriter &writer, const ofxBlendScreen::Shader::Params &t);
+template<> void SaveData::unpack<ofxBlendScreen::Shader::Params>(ByteReader &reader, ofxBlendScreen::Shader::Params &t);
@@ -1,9 +1,15 @@
 #include "ofMain.h"
 #include "ofApp.h"
 #include "ofAppGLFWWindow.h"
+#include "CommandLine.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char *argv[]){
+	int exit_code = 0;
+	if(cli::run(argc, argv, exit_code)) {
+		return exit_code;
+	}
+
 	ofGLFWWindowSettings settings;
 
 	settings.setGLVersion(4,1);
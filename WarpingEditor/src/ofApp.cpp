@@ -3,17 +3,19 @@
 #include "GuiFunc.h"
 #include "Icon.h"
 #include "ImGuiFileDialog.h"
+#include "ProjectExport.h"
 
 namespace {
 template<typename T>
 auto getJsonValue(const ofJson &json, const std::string &key, T default_value={}) -> T {
 	return json.contains(key) ? json[key].get<T>() : default_value;
 }
-std::shared_ptr<ImageSource> buildTextureSource(const ProjectFolder &proj) {
-	std::shared_ptr<ImageSource> ret = std::make_shared<ImageSource>();
+// passing the current source keeps its texture on screen while a still image is decoding
+std::shared_ptr<ImageSource> buildTextureSource(const ProjectFolder &proj, std::shared_ptr<ImageSource> current=nullptr) {
+	std::shared_ptr<ImageSource> ret = current ? current : std::make_shared<ImageSource>();
 	switch(proj.getTextureType()) {
 		case ProjectFolder::Texture::FILE:
-			if(ret->loadFromFile(proj.getTextureFilePath())) {
+			if(ret->loadFromFileAsync(proj.getTextureFilePath())) {
 				return ret;
 			}
 			break;
@@ -22,9 +24,43 @@ std::shared_ptr<ImageSource> buildTextureSource(const ProjectFolder &proj) {
 				return ret;
 			}
 			break;
+		case ProjectFolder::Texture::SEQUENCE:
+			if(ret->loadSequence(proj.getTextureSequencePath(), proj.getTextureSequenceFps())) {
+				return ret;
+			}
+			break;
 	}
 	return nullptr;
 }
+// the part of the texture the visible warps show, in texture pixels, and the most bridge pixels
+// one of its texels covers(on average over a mesh). scale is 0 if nothing is shown.
+void getTextureUsage(const WarpingData &data, ofRectangle &region, float &scale) {
+	region = {};
+	scale = 0;
+	bool is_first = true;
+	for(auto &&d : data.getVisibleData()) {
+		auto &&warp = *d.second;
+		ofRectangle uv;
+		uv.set(warp.uv_quad->lt, 0, 0);
+		for(auto &&p : *warp.uv_quad) {
+			uv.growToInclude(p);
+		}
+		auto &&mesh = *warp.mesh;
+		ofRectangle verts;
+		verts.set(glm::vec2(*mesh.getPoint(0, 0).v), 0, 0);
+		for(int r = 0; r <= mesh.getNumRows(); ++r) {
+			for(int c = 0; c <= mesh.getNumCols(); ++c) {
+				verts.growToInclude(glm::vec2(*mesh.getPoint(c, r).v));
+			}
+		}
+		if(uv.width <= 0 || uv.height <= 0) {
+			continue;
+		}
+		region = is_first ? uv : region.getUnion(uv);
+		is_first = false;
+		scale = std::max({scale, verts.width/uv.width, verts.height/uv.height});
+	}
+}
 }
 
 std::string GuiApp::stateName(int state) const
@@ -87,8 +123,24 @@ void GuiApp::initUndo()
 //--------------------------------------------------------------
 void GuiApp::update(){
 	if(texture_source_) {
-		auto tex = texture_source_->getTexture();
+		// only the uv editor looks at the texture itself; elsewhere it feeds the bridge,
+		// which needs no more of it than the warps map and no more texels than they cover
+		if(state_ == EDIT_WARP_UV) {
+			texture_source_->setRegionOfInterest(warp_uv_->getVisibleWorkArea(), warp_uv_->getScale());
+		}
+		else {
+			ofRectangle region;
+			float scale;
+			getTextureUsage(*warping_data_, region, scale);
+			if(state_ == EDIT_WARP_MESH) {
+				// zoomed in, the mesh editor shows the bridge larger than the output does
+				scale *= std::max(1.f, warp_mesh_->getScale());
+			}
+			texture_source_->setRegionOfInterest(region, scale);
+		}
+		// update first; an async load may have swapped in a different texture
 		texture_source_->update();
+		auto tex = texture_source_->getTexture();
 		if(texture_source_->isFrameNew()) {
 			warp_uv_->setTexture(tex);
 			warp_mesh_->setTexture(tex);
@@ -183,6 +235,20 @@ void GuiApp::draw(){
 			if(MenuItem("Save as...", sc_save_as.keyStr().c_str())) {
 				sc_save_as();
 			}
+			Separator();
+			if(BeginMenu("Restore backup", proj_.isBackupEnabled())) {
+				if(auto store = getBackupStore()) {
+					auto points = store->getPoints();
+					for(int i = points.size(); i-- > 0;) {
+						std::stringstream ss;
+						ss << points[i].label << "(" << points[i].size/1024 << "kB)";
+						if(MenuItem(ss.str().c_str())) {
+							restoreBackup(i);
+						}
+					}
+				}
+				ImGui::EndMenu();
+			}
 			ImGui::EndMenu();
 		}
 		if(BeginMenu("Edit")) {
@@ -204,7 +270,7 @@ void GuiApp::draw(){
 				if(SelectFileMenu(proj_.getRelative().string(), filepath, true, {"png","gif","jpg","jpeg","mov","mp4"})) {
 					filepath = ofToDataPath(filepath, true);
 					proj_.setTextureSourceFile(filepath);
-					if((texture_source_ = buildTextureSource(proj_))) {
+					if((texture_source_ = buildTextureSource(proj_, texture_source_))) {
 						auto tex = texture_source_->getTexture();
 						if(tex.isAllocated()) {
 							warp_uv_->setTexture(tex);
@@ -214,6 +280,19 @@ void GuiApp::draw(){
 				}
 				ImGui::EndMenu();
 			}
+			if(BeginMenu("Image Sequence")) {
+				if(MenuItem("Load from folder...")) {
+					ImGuiFileDialog::Instance()->OpenModal("ChooseSequenceDlgKey", "Choose Sequence Folder", nullptr, ofFilePath::addTrailingSlash(proj_.getAbsolute().string()));
+				}
+				float fps = proj_.getTextureSequenceFps();
+				if(InputFloat("fps", &fps) && fps > 0) {
+					proj_.setTextureSequenceFps(fps);
+				}
+				if(IsItemDeactivatedAfterEdit() && proj_.getTextureType() == ProjectFolder::Texture::SEQUENCE) {
+					texture_source_ = buildTextureSource(proj_, texture_source_);
+				}
+				ImGui::EndMenu();
+			}
 			if(BeginMenu("NDI")) {
 				auto source = ndi_finder_.getSources();
 				for(auto &&s : source) {
@@ -284,6 +363,19 @@ void GuiApp::draw(){
 			}
 			TreePop();
 		}
+		if(TreeNodeEx("uv map", ImGuiTreeNodeFlags_DefaultOpen)) {
+			auto param = proj_.getExportUVMapParam();
+			int format = param.is_unorm16 ? 1 : 0;
+			if(Checkbox("enabled", &param.enabled)
+			   | EditText("filename", param.filename)
+			   | Checkbox("16bit png pair", &param.is_png)
+			   | (!param.is_png && Combo("format", &format, "float32\0unorm16\0"))
+			   | Checkbox("with blend", &param.with_blend)) {
+				param.is_unorm16 = format == 1;
+				proj_.setExportUVMapParam(param);
+			}
+			TreePop();
+		}
 		if(Button("export")) {
 			sc_export();
 			CloseCurrentPopup();
@@ -307,6 +399,8 @@ void GuiApp::draw(){
 			std::string filePath = ImGuiFileDialog::Instance()->GetCurrentPath();
 			proj_.WorkFolder::setRelative(filePathName);
 			save();
+			// setup() reads project.json back, so it has to be on disk already
+			saver_.wait();
 			proj_.setup();
 			updateRecent(proj_);
 		}
@@ -317,7 +411,7 @@ void GuiApp::draw(){
 			std::string filePathName = ImGuiFileDialog::Instance()->GetFilePathName();
 			std::string filePath = ImGuiFileDialog::Instance()->GetCurrentPath();
 			proj_.setTextureSourceFile(filePathName);
-			if((texture_source_ = buildTextureSource(proj_))) {
+			if((texture_source_ = buildTextureSource(proj_, texture_source_))) {
 				auto tex = texture_source_->getTexture();
 				if(tex.isAllocated()) {
 					warp_uv_->setTexture(tex);
@@ -327,7 +421,47 @@ void GuiApp::draw(){
 		}
 		ImGuiFileDialog::Instance()->Close();
 	}
+	if(ImGuiFileDialog::Instance()->Display("ChooseSequenceDlgKey")) {
+		if (ImGuiFileDialog::Instance()->IsOk() == true) {
+			std::string filePathName = ImGuiFileDialog::Instance()->GetFilePathName();
+			proj_.setTextureSourceSequence(filePathName);
+			texture_source_ = buildTextureSource(proj_, texture_source_);
+		}
+		ImGuiFileDialog::Instance()->Close();
+	}
 	if(Begin("status")) {
+		{
+			auto status = saver_.getStatus();
+			switch(status.state) {
+				case AsyncFileWriter::IDLE:
+					Text("%s", "save: -");
+					break;
+				case AsyncFileWriter::WRITING:
+					Text("save: writing...(%d pending)", (int)status.num_pending);
+					break;
+				case AsyncFileWriter::SUCCEEDED:
+					Text("save: %s", status.message.c_str());
+					break;
+				case AsyncFileWriter::FAILED:
+					TextColored(ImVec4(1,0.3f,0.3f,1), "save failed: %s", status.message.c_str());
+					break;
+			}
+		}
+		UploadRing::Stats upload_stats;
+		if(texture_source_ && texture_source_->getUploadStats(upload_stats) && TreeNode("texture upload")) {
+			Text("frames: %llu uploaded / %llu pushed", (unsigned long long)upload_stats.uploaded, (unsigned long long)upload_stats.pushed);
+			Text("dropped: %llu", (unsigned long long)upload_stats.dropped);
+			Text("latency: %.2fms (max %.2fms)", upload_stats.latency_ms, upload_stats.max_latency_ms);
+			TreePop();
+		}
+		VideoDecoder::Stats decode_stats;
+		if(texture_source_ && texture_source_->getDecodeStats(decode_stats) && TreeNode("video decode")) {
+			Text("queue: %d / %d", (int)decode_stats.queue_depth, (int)decode_stats.queue_capacity);
+			Text("frames: %llu presented / %llu decoded", (unsigned long long)decode_stats.presented, (unsigned long long)decode_stats.decoded);
+			Text("late: %llu", (unsigned long long)decode_stats.late);
+			Text("underrun: %llu", (unsigned long long)decode_stats.underrun);
+			TreePop();
+		}
 		if(TreeNode("undo/redo")) {
 			int max_length = (int)undo_.getHistoryLengthLimit();
 			if(InputInt("max length", &max_length)) {
@@ -431,51 +565,13 @@ void GuiApp::exportMesh(float resample_min_interval, const std::filesystem::path
 	warping_data_->exportMesh(filepath, resample_min_interval, coord_size);
 }
 
-namespace nlohmann {
-template<typename T>
-struct adl_serializer<glm::tvec3<T>> {
-	static void to_json(ofJson &j, const glm::tvec3<T> &v) {
-		j = {v[0],v[1],v[2]};
-	}
-	static void from_json(const ofJson &j, glm::tvec3<T> &v) {
-		v = {j[0],j[1],j[2]};
-	}
-};
-template<>
-struct adl_serializer<ofxBlendScreen::Shader::Params> {
-	static void to_json(ofJson &j, const ofxBlendScreen::Shader::Params &v) {
-		j = {
-			{"gamma", v.gamma},
-			{"luminance_control", v.luminance_control},
-			{"blend_power", v.blend_power},
-			{"base_color", v.base_color}
-		};
-	}
-};
-}
 void GuiApp::exportMesh(const ProjectFolder &proj) const
 {
-	std::string folder = proj_.getExportFolder();
-	bool is_arb = proj_.getIsExportMeshArb();
-	{
-		auto param = proj_.getExportWarpParam();
-		auto tex = texture_source_->getTexture();
-		glm::vec2 coord_size = is_arb&&tex.isAllocated()?glm::vec2{1,1}: glm::vec2{1/tex.getWidth(), 1/tex.getHeight()};
-		warping_data_->exportMesh(ofFilePath::join(folder, param.filename), param.max_mesh_size, coord_size);
-	}
-	{
-		auto param = proj_.getExportBlendParam();
-		auto tex = fbo_.getTexture();
-		glm::vec2 coord_size = is_arb&&tex.isAllocated()?glm::vec2{1,1}: glm::vec2{1/tex.getWidth(), 1/tex.getHeight()};
-		blending_data_->exportMesh(ofFilePath::join(folder, param.filename), param.max_mesh_size, coord_size);
-	}
-	{
-		auto param = proj_.getExportBlendShaderParam();
-		ofSavePrettyJson(ofFilePath::join(folder, param.filename), blending_data_->getShader()->getParams());
-	}
+	auto tex = texture_source_->getTexture();
+	glm::vec2 tex_size = tex.isAllocated() ? glm::vec2{tex.getWidth(), tex.getHeight()} : glm::vec2{proj_.getTextureSizeCache()};
+	exportProject(proj_, *warping_data_, *blending_data_, tex_size, {fbo_.getWidth(), fbo_.getHeight()});
 }
 
-
 //--------------------------------------------------------------
 void GuiApp::keyPressed(int key){
 	if(ImGui::GetIO().WantCaptureKeyboard) {
@@ -531,44 +627,99 @@ void GuiApp::save(bool do_backup) const
 	
 	proj_.setBridgeResolution({fbo_.getWidth(), fbo_.getHeight()});
 	
-	proj_.save();
-
+	// everything is serialized here so the editors can keep changing while the worker writes
+	AsyncFileWriter::Job job;
+	{
+		auto json = proj_.toJsonString();
+		job.files.push_back({proj_.getProjFilePath(), {json.begin(), json.end()}});
+	}
 	auto filepath = proj_.getDataFilePath();
-	saveDataFile(filepath);
-
+	std::vector<std::size_t> split_points;
+	{
+		ByteWriter writer;
+		packDataFile(writer);
+		split_points = writer.getMarks();
+		job.files.push_back({filepath, writer.release()});
+	}
 	if(do_backup && proj_.isBackupEnabled()) {
-		auto backup_path = proj_.getBackupFilePath();
-		ofDirectory folder(ofFilePath::getEnclosingDirectory(backup_path));
-		if(!folder.exists()) {
-			folder.create();
-		}
-		ofFile(filepath).copyTo(backup_path);
-		int num = proj_.getBackupNumLimit();
-		if(num > 0) {
-			folder.allowExt(ofFilePath::getFileExt(backup_path));
-			folder.sortByDate();
-			for(int i = 0; i < folder.size() - num; ++i) {
-				folder.getFile(i).remove();
-			}
+		if(auto store = getBackupStore()) {
+			auto label = ofGetTimestampString("%Y%m%d_%H%M%S");
+			std::size_t limit = std::max(0, proj_.getBackupNumLimit());
+			job.after = [store, filepath, split_points, label, limit]() {
+				// read back what was just written; it's still in the page cache
+				MappedFile file(filepath);
+				if(file.isOpen() && store->add(label, file.data(), file.size(), split_points)) {
+					store->prune(limit);
+				}
+			};
 		}
 	}
+	saver_.push(std::move(job));
+}
+
+std::shared_ptr<BackupStore> GuiApp::getBackupStore() const
+{
+	auto folder = proj_.getBackupStorePath();
+	if(!backup_store_ || backup_store_->getFolder() != folder) {
+		auto store = std::make_shared<BackupStore>();
+		if(!store->setup(folder)) {
+			return nullptr;
+		}
+		backup_store_ = store;
+		auto legacy = proj_.getLegacyBackupFiles();
+		if(!legacy.empty()) {
+			AsyncFileWriter::Job job;
+			job.after = [store, legacy]() {
+				store->importFiles(legacy);
+			};
+			saver_.push(std::move(job));
+		}
+	}
+	return backup_store_;
+}
+
+void GuiApp::restoreBackup(std::size_t index)
+{
+	auto store = getBackupStore();
+	std::vector<char> data;
+	if(!store || !store->restore(index, data)) {
+		ofLogError("GuiApp") << "failed to restore backup";
+		return;
+	}
+	unpackDataFile(data.data(), data.size());
+	undo_.store();
 }
 
 void GuiApp::saveDataFile(const std::filesystem::path &filepath) const
 {
-	ofFile file(filepath, ofFile::WriteOnly);
-	packDataFile(file);
-	file.close();
+	ByteWriter writer;
+	packDataFile(writer);
+	std::string error;
+	if(!AsyncFileWriter::writeAtomic(filepath, writer.data(), writer.size(), &error)) {
+		ofLogError("GuiApp") << error;
+	}
 }
 
 void GuiApp::loadDataFile(const std::filesystem::path &filepath)
 {
-	ofFile file(filepath, ofFile::ReadOnly);
-	unpackDataFile(file);
-	file.close();
+	MappedFile file(filepath);
+	if(!file.isOpen()) {
+		return;
+	}
+	unpackDataFile(file.data(), file.size());
 }
 
 void GuiApp::packDataFile(std::ostream &stream) const
+{
+	createDataFileSaver().pack(stream);
+}
+
+void GuiApp::packDataFile(ByteWriter &writer) const
+{
+	createDataFileSaver().pack(writer);
+}
+
+SaveData GuiApp::createDataFileSaver() const
 {
 	SaveData saver;
 	{
@@ -581,10 +732,10 @@ void GuiApp::packDataFile(std::ostream &stream) const
 		blending_data_->setPackArg({1/tex_size.x, 1/tex_size.y});
 		saver.append((char *)"blnd", blending_data_);
 	}
-	saver.pack(stream);
+	return saver;
 }
 
-void GuiApp::unpackDataFile(std::istream &stream)
+SaveData GuiApp::createDataFileLoader()
 {
 	SaveData loader;
 	{
@@ -597,12 +748,26 @@ void GuiApp::unpackDataFile(std::istream &stream)
 		blending_data_->setUnpackArg(tex_size);
 		loader.append((char *)"blnd", blending_data_);
 	}
-	loader.unpack(stream);
+	return loader;
+}
+
+void GuiApp::unpackDataFile(std::istream &stream)
+{
+	createDataFileLoader().unpack(stream);
+}
+
+void GuiApp::unpackDataFile(const char *data, std::size_t size)
+{
+	if(!createDataFileLoader().unpack(data, size)) {
+		ofLogError("GuiApp") << "failed to load data";
+	}
 }
 
 
 void GuiApp::openProject(const std::filesystem::path &proj_path)
 {
+	// a save still in flight may target the folder being opened
+	saver_.wait();
 	proj_.WorkFolder::setRelative(proj_path);
 	proj_.setup();
 
@@ -11,6 +11,8 @@
 #include "ProjectFolder.h"
 #include "Undo.h"
 #include "SaveData.h"
+#include "AsyncFileWriter.h"
+#include "BackupStore.h"
 
 class ResultView;
 
@@ -29,7 +31,9 @@ public:
 	void saveDataFile(const std::filesystem::path &filepath) const;
 	void loadDataFile(const std::filesystem::path &filepath);
 	void packDataFile(std::ostream &stream) const;
+	void packDataFile(ByteWriter &writer) const;
 	void unpackDataFile(std::istream &stream);
+	void unpackDataFile(const char *data, std::size_t size);
 	
 	void keyPressed(int key) override;
 	void mouseReleased(int x, int y, int button) override;
@@ -75,10 +79,17 @@ private:
 	ofxNDIFinder ndi_finder_;
 	
 	mutable ProjectFolder proj_;
+	mutable AsyncFileWriter saver_;
+	mutable std::shared_ptr<BackupStore> backup_store_;
+	std::shared_ptr<BackupStore> getBackupStore() const;
+	void restoreBackup(std::size_t index);
 	
 	Undo undo_;
 	void initUndo();
 	
+	SaveData createDataFileSaver() const;
+	SaveData createDataFileLoader();
+	
 	ofFbo fbo_;
 };
 
@@ -0,0 +1,212 @@
+#include "BatchRenderer.h"
+#include "BoundedQueue.h"
+#include "ofVideoPlayer.h"
+#include "ofImage.h"
+#include "ofUtils.h"
+#include "ofLog.h"
+#include <thread>
+#include <chrono>
+
+namespace {
+// pulls frames one by one out of whatever the input is, never dropping any
+class FrameReader {
+public:
+	bool open(const std::filesystem::path &input) {
+		ofDirectory dir(input.string());
+		if(dir.isDirectory()) {
+			for(auto &&ext : {"png","jpg","jpeg","tif","tiff","bmp"}) {
+				dir.allowExt(ext);
+			}
+			dir.listDir();
+			dir.sort();
+			for(auto &&f : dir) {
+				files_.push_back(f.getAbsolutePath());
+			}
+			return !files_.empty();
+		}
+		auto ext = ofToLower(ofFilePath::getFileExt(input));
+		if(ofContains(std::vector<std::string>{"mov","mp4","mpg","wmv"}, ext)) {
+			player_.setUseTexture(false);
+			if(!player_.load(input.string())) {
+				return false;
+			}
+			player_.setLoopState(OF_LOOP_NONE);
+			player_.play();
+			player_.setPaused(true);
+			is_video_ = true;
+			return true;
+		}
+		files_.push_back(input);
+		return true;
+	}
+	bool read(ofPixels &dst) {
+		if(is_video_) {
+			if(index_ > 0) {
+				player_.nextFrame();
+			}
+			if(!waitForFrame()) {
+				return false;
+			}
+			dst = player_.getPixels();
+			++index_;
+			return true;
+		}
+		while(index_ < files_.size()) {
+			auto &&file = files_[index_++];
+			if(ofLoadImage(dst, file)) {
+				return true;
+			}
+			ofLogWarning("BatchRenderer") << "skipped, failed to decode: " << file;
+		}
+		return false;
+	}
+private:
+	std::vector<std::filesystem::path> files_;
+	ofVideoPlayer player_;
+	bool is_video_=false;
+	std::size_t index_=0;
+
+	bool waitForFrame() {
+		auto start = std::chrono::steady_clock::now();
+		while(std::chrono::steady_clock::now()-start < std::chrono::seconds(1)) {
+			player_.update();
+			if(player_.isFrameNew()) {
+				return true;
+			}
+			if(player_.getIsMovieDone()) {
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+};
+
+struct Frame {
+	std::size_t index;
+	ofPixels pixels;
+};
+struct Rendered {
+	std::size_t index;
+	std::vector<ofPixels> images;
+};
+}
+
+void BatchRenderer::setup(std::shared_ptr<WarpingData> warp, std::shared_ptr<BlendingData> blend, const glm::ivec2 &bridge_resolution)
+{
+	warp_ = warp;
+	bridge_resolution_ = bridge_resolution;
+	outputs_.clear();
+	ofRectangle bridge(0, 0, bridge_resolution.x, bridge_resolution.y);
+	for(auto &&d : blend->getVisibleData()) {
+		auto rect = BlendMask::getOutputRect(*d.second, bridge_resolution);
+		if(!rect.isEmpty()) {
+			// a mask per output; in an overlap each projector needs its own ramp, not the one on top
+			outputs_.push_back({d.first, rect});
+			outputs_.back().mask.setup(*d.second, blend->getShader()->getParams(), bridge_resolution);
+		}
+	}
+	use_mask_ = !outputs_.empty();
+	if(!use_mask_) {
+		// nothing to blend, so the bridge goes out as it is
+		outputs_.push_back({"bridge", bridge});
+	}
+}
+
+bool BatchRenderer::run(const Settings &settings)
+{
+	decoded_ = rendered_ = written_ = failed_ = 0;
+	if(!std::filesystem::exists(settings.input)) {
+		ofLogError("BatchRenderer") << "no such input: " << settings.input;
+		return false;
+	}
+	for(auto &&o : outputs_) {
+		ofDirectory dir(ofFilePath::join(settings.output, o.name));
+		if(!dir.exists() && !dir.create(true)) {
+			ofLogError("BatchRenderer") << "failed to create: " << dir.getAbsolutePath();
+			return false;
+		}
+	}
+	warp_mesh_ = warp_->getMeshForExport(settings.resample_min_interval, {1,1});
+
+	BoundedQueue<Frame> decoded(settings.queue_size);
+	BoundedQueue<Rendered> rendered(settings.queue_size);
+
+	std::thread decoder([&]() {
+		// opened, stepped and closed on this thread only; ofVideoPlayer can't be shared between threads
+		FrameReader reader;
+		if(!reader.open(settings.input)) {
+			ofLogError("BatchRenderer") << "failed to open: " << settings.input;
+			decoded.close();
+			return;
+		}
+		Frame frame{0};
+		while((settings.max_frames == 0 || frame.index < settings.max_frames) && reader.read(frame.pixels)) {
+			++decoded_;
+			Frame next{frame.index+1};
+			if(!decoded.push(std::move(frame))) {
+				break;
+			}
+			frame = std::move(next);
+		}
+		decoded.close();
+	});
+	std::thread renderer([&]() {
+		Frame frame;
+		ofPixels bridge;
+		bridge.allocate(bridge_resolution_.x, bridge_resolution_.y, OF_PIXELS_RGB);
+		while(decoded.pop(frame)) {
+			bridge.set(0);
+			rasterizer_.draw(warp_mesh_, frame.pixels, bridge);
+			Rendered result{frame.index};
+			for(auto &&o : outputs_) {
+				ofPixels image;
+				bridge.cropTo(image, o.rect.x, o.rect.y, o.rect.width, o.rect.height);
+				if(use_mask_) {
+					o.mask.apply(image);
+				}
+				result.images.push_back(std::move(image));
+			}
+			++rendered_;
+			if(!rendered.push(std::move(result))) {
+				break;
+			}
+		}
+		rendered.close();
+	});
+	std::vector<std::thread> writers;
+	for(std::size_t i = 0; i < std::max<std::size_t>(1, settings.num_writers); ++i) {
+		writers.emplace_back([&]() {
+			Rendered result;
+			while(rendered.pop(result)) {
+				auto filename = ofToString(result.index, 6, '0')+"."+settings.extension;
+				for(std::size_t n = 0; n < outputs_.size(); ++n) {
+					auto path = ofFilePath::join(ofFilePath::join(settings.output, outputs_[n].name), filename);
+					if(ofSaveImage(result.images[n], path)) {
+						++written_;
+					}
+					else {
+						ofLogError("BatchRenderer") << "failed to write: " << path;
+						++failed_;
+					}
+				}
+			}
+		});
+	}
+	decoder.join();
+	renderer.join();
+	for(auto &&w : writers) {
+		w.join();
+	}
+	return failed_ == 0 && decoded_ > 0;
+}
+
+BatchRenderer::Stats BatchRenderer::getStats() const
+{
+	Stats ret;
+	ret.decoded = decoded_;
+	ret.rendered = rendered_;
+	ret.written = written_;
+	ret.failed = failed_;
+	return ret;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "MeshData.h"
+#include "SoftRasterizer.h"
+#include "BlendMask.h"
+#include <atomic>
+
+// renders a video, an image sequence or a still through a project's warp and blend on the CPU,
+// writing one image sequence per visible blending mesh(i.e. per projector).
+// decoding, warping/blending and writing run as a pipeline, each stage on its own thread(s).
+class BatchRenderer
+{
+public:
+	struct Settings {
+		std::filesystem::path input;	// video file, still image or folder of stills
+		std::filesystem::path output;	// gets a sub folder per blending mesh
+		std::string extension="png";
+		std::size_t max_frames=0;	// 0 for all
+		std::size_t queue_size=4;
+		std::size_t num_writers=2;
+		float resample_min_interval=100;
+	};
+	struct Stats {
+		std::size_t decoded=0, rendered=0, written=0, failed=0;
+	};
+	// warp unpacked with unit scale(texture coordinates normalized), blend in bridge pixels
+	void setup(std::shared_ptr<WarpingData> warp, std::shared_ptr<BlendingData> blend, const glm::ivec2 &bridge_resolution);
+	bool run(const Settings &settings);
+	Stats getStats() const;
+private:
+	struct Output {
+		std::string name;
+		ofRectangle rect;
+		BlendMask mask;	// the projector's own ramps, applied after cropping
+	};
+	ofMesh warp_mesh_;
+	bool use_mask_=false;
+	glm::ivec2 bridge_resolution_;
+	std::vector<Output> outputs_;
+	SoftRasterizer rasterizer_;
+	std::shared_ptr<WarpingData> warp_;
+	std::atomic<std::size_t> decoded_{0}, rendered_{0}, written_{0}, failed_{0};
+};
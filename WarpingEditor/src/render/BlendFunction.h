@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ofxBlendScreen.h"
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+
+// the edge blending curve of ofxBlendScreen::Shader, for rendering blends without a GPU.
+// positions run across an overlap from 0 at the outer edge to 1 where the overlap ends;
+// pixels outside any overlap are at 1.
+// BlendShaderCheck compares it with the shader itself, from the Blending window("check against CPU") or `check-shader`.
+namespace blend {
+using Params = ofxBlendScreen::Shader::Params;
+
+// luminance_control is the value at the middle of the overlap, blend_power the steepness of both halves
+inline float ramp(float x, float luminance_control, float power) {
+	x = std::max(0.f, std::min(1.f, x));
+	return x < 0.5f
+	? luminance_control*std::pow(2*x, power)
+	: 1-(1-luminance_control)*std::pow(2*(1-x), power);
+}
+
+// per channel multiplier at a pixel with horizontal/vertical overlap positions x and y
+inline glm::vec3 gain(float x, float y, const Params &p) {
+	float g = ramp(x, p.luminance_control, p.blend_power)*ramp(y, p.luminance_control, p.blend_power);
+	auto channel = [g](float gamma) { return gamma > 0 ? std::pow(g, 1/gamma) : (g < 1 ? 0.f : 1.f); };
+	return {channel(p.gamma[0]), channel(p.gamma[1]), channel(p.gamma[2])};
+}
+
+// gain() for n pixels at once. arrays in, arrays out and no branches, so the loops vectorize.
+// out receives n values per channel: r at [0,n), g at [n,2n), b at [2n,3n).
+inline void gain(const float *x, const float *y, std::size_t n, const Params &p, float *out) {
+	const float lum = p.luminance_control, power = p.blend_power;
+	auto ramp_v = [lum, power](float v) {
+		v = std::max(0.f, std::min(1.f, v));
+		float lo = lum*std::pow(2*v, power);
+		float hi = 1-(1-lum)*std::pow(2*(1-v), power);
+		return v < 0.5f ? lo : hi;
+	};
+	float *g = out;
+	for(std::size_t i = 0; i < n; ++i) {
+		g[i] = ramp_v(x[i])*ramp_v(y[i]);
+	}
+	// red last, it is computed in place over the product the others read
+	for(int c = 2; c >= 0; --c) {
+		float gamma = p.gamma[c];
+		float inv = gamma > 0 ? 1/gamma : 0;
+		float *dst = out + c*n;
+		for(std::size_t i = 0; i < n; ++i) {
+			dst[i] = gamma > 0 ? std::pow(g[i], inv) : (g[i] < 1 ? 0.f : 1.f);
+		}
+	}
+}
+
+// base_color lifts the black level of the source before the blend is applied
+inline float apply(float color, float gain, float base) {
+	return (base + (1-base)*color)*gain;
+}
+}
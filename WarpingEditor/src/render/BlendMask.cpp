@@ -0,0 +1,174 @@
+#include "BlendMask.h"
+#include "BlendFunction.h"
+#include "ofLog.h"
+#include <thread>
+
+namespace {
+std::uint16_t toShort(float v) {
+	return (std::uint16_t)std::max(0.f, std::min(65535.f, v*65535+0.5f));
+}
+}
+
+BlendMask::Shape BlendMask::getShape(const BlendingMesh &mesh)
+{
+	Shape ret;
+	ret.outer = mesh.mesh->quad[0];
+	const auto &inner = mesh.mesh->quad[1];
+	// the result is meaningful even when a corner pokes out of the outer quad
+	geom::normalizedPosition(ret.outer, inner.lt, ret.lt);
+	geom::normalizedPosition(ret.outer, inner.rt, ret.rt);
+	geom::normalizedPosition(ret.outer, inner.lb, ret.lb);
+	geom::normalizedPosition(ret.outer, inner.rb, ret.rb);
+	ret.l = mesh.blend_l; ret.r = mesh.blend_r;
+	ret.t = mesh.blend_t; ret.b = mesh.blend_b;
+	return ret;
+}
+
+bool BlendMask::getPosition(const Shape &shape, glm::vec2 point, glm::vec2 &result)
+{
+	glm::vec2 st;
+	if(!geom::normalizedPosition(shape.outer, point, st)) {
+		return false;
+	}
+	float left = ofLerp(shape.lt.x, shape.lb.x, st.y), right = ofLerp(shape.rt.x, shape.rb.x, st.y);
+	float top = ofLerp(shape.lt.y, shape.rt.y, st.x), bottom = ofLerp(shape.lb.y, shape.rb.y, st.x);
+	result = {1,1};
+	if(shape.l && st.x < left && left > 0) result.x = st.x/left;
+	else if(shape.r && st.x > right && right < 1) result.x = (1-st.x)/(1-right);
+	if(shape.t && st.y < top && top > 0) result.y = st.y/top;
+	else if(shape.b && st.y > bottom && bottom < 1) result.y = (1-st.y)/(1-bottom);
+	return true;
+}
+
+ofRectangle BlendMask::getOutputRect(const BlendingMesh &mesh, const glm::ivec2 &bridge_resolution)
+{
+	const auto &outer = mesh.mesh->quad[0];
+	ofRectangle rect;
+	rect.set(outer.lt, 0, 0);
+	for(auto &&p : outer) {
+		rect.growToInclude(p);
+	}
+	rect = rect.getIntersection({0, 0, (float)bridge_resolution.x, (float)bridge_resolution.y});
+	// whole pixels, so every frame of an output has the same size
+	float x = std::floor(rect.x), y = std::floor(rect.y);
+	return {x, y, std::ceil(rect.getRight())-x, std::ceil(rect.getBottom())-y};
+}
+
+void BlendMask::setup(const BlendingData &data, const glm::ivec2 &size, bool bake)
+{
+	shapes_.clear();
+	for(auto &&d : data.getVisibleData()) {
+		shapes_.push_back(getShape(*d.second));
+	}
+	offset_ = {0,0};
+	setupGains(data.getShader()->getParams(), size, bake);
+}
+
+void BlendMask::setup(const BlendingMesh &mesh, const Params &params, const glm::ivec2 &bridge_resolution, bool bake)
+{
+	shapes_.assign(1, getShape(mesh));
+	auto rect = getOutputRect(mesh, bridge_resolution);
+	offset_ = {rect.x, rect.y};
+	setupGains(params, {(int)rect.width, (int)rect.height}, bake);
+}
+
+void BlendMask::setupGains(const Params &params, const glm::ivec2 &size, bool bake)
+{
+	size_ = size;
+	params_ = params;
+	for(int c = 0; c < 3; ++c) {
+		for(int v = 0; v < 256; ++v) {
+			lift_[c][v] = (std::uint16_t)std::round(blend::apply(v/255.f, 1, params_.base_color[c])*255*256);
+		}
+	}
+	if(bake) {
+		gain_.resize(std::size_t(size.x)*size.y*3);
+		compute(0, 0, size.x, size.y, gain_.data(), std::size_t(size.x)*3);
+	}
+	else {
+		std::vector<std::uint16_t>().swap(gain_);
+	}
+}
+
+void BlendMask::compute(int x0, int y0, int x1, int y1, std::uint16_t *dst, std::size_t stride) const
+{
+	const int width = x1-x0;
+	auto work = [&](int row_begin, int row_end) {
+		std::vector<float> x(width), y(width), gain(width*3);
+		std::vector<bool> covered(width);
+		for(int row = row_begin; row < row_end; ++row) {
+			for(int i = 0; i < width; ++i) {
+				glm::vec2 pos{1,1};
+				covered[i] = false;
+				// meshes drawn later cover earlier ones
+				for(auto it = shapes_.rbegin(); it != shapes_.rend(); ++it) {
+					if(getPosition(*it, offset_+glm::vec2{x0+i+0.5f, row+0.5f}, pos)) {
+						covered[i] = true;
+						break;
+					}
+				}
+				x[i] = pos.x;
+				y[i] = pos.y;
+			}
+			blend::gain(x.data(), y.data(), width, params_, gain.data());
+			std::uint16_t *out = dst + std::size_t(row-y0)*stride;
+			for(int i = 0; i < width; ++i) {
+				for(int c = 0; c < 3; ++c) {
+					out[i*3+c] = covered[i] ? toShort(gain[c*width+i]) : 0;
+				}
+			}
+		}
+	};
+	std::vector<std::thread> threads;
+	for(std::size_t i = 0; i < num_threads_; ++i) {
+		int begin = y0+(y1-y0)*i/num_threads_, end = y0+(y1-y0)*(i+1)/num_threads_;
+		if(begin < end) {
+			threads.emplace_back(work, begin, end);
+		}
+	}
+	for(auto &&t : threads) {
+		t.join();
+	}
+}
+
+void BlendMask::apply(ofPixels &pixels) const
+{
+	if(pixels.getWidth() != size_.x || pixels.getHeight() != size_.y || pixels.getNumChannels() < 3) {
+		ofLogError("BlendMask") << "size or format mismatch";
+		return;
+	}
+	if(gain_.empty()) {
+		ofLogError("BlendMask") << "not baked";
+		return;
+	}
+	const std::size_t channels = pixels.getNumChannels();
+	const std::size_t num_pixels = std::size_t(size_.x)*size_.y;
+	unsigned char *data = pixels.getData();
+	const std::uint16_t *gain = gain_.data();
+	// integer only: (value*256)*(gain*65535) fits in 32 bits, shifted back by 24 with rounding
+	for(std::size_t i = 0; i < num_pixels; ++i) {
+		unsigned char *p = data + i*channels;
+		const std::uint16_t *g = gain + i*3;
+		for(int c = 0; c < 3; ++c) {
+			std::uint32_t v = std::uint32_t(lift_[c][p[c]])*g[c];
+			p[c] = (v + (1u<<23)) >> 24;
+		}
+	}
+}
+
+void BlendMask::getMask(ofShortPixels &dst, const ofRectangle &rect) const
+{
+	int x0 = std::max(0, (int)rect.x), y0 = std::max(0, (int)rect.y);
+	int x1 = std::min(size_.x, (int)(rect.x+rect.width)), y1 = std::min(size_.y, (int)(rect.y+rect.height));
+	dst.allocate(std::max(0, x1-x0), std::max(0, y1-y0), OF_PIXELS_RGB);
+	if(x1 <= x0 || y1 <= y0) {
+		return;
+	}
+	if(gain_.empty()) {
+		compute(x0, y0, x1, y1, dst.getData(), std::size_t(x1-x0)*3);
+		return;
+	}
+	for(int y = y0; y < y1; ++y) {
+		std::copy_n(gain_.data() + (std::size_t(y)*size_.x+x0)*3, (x1-x0)*3, dst.getData() + std::size_t(y-y0)*(x1-x0)*3);
+	}
+}
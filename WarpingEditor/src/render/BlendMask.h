@@ -0,0 +1,56 @@
+#pragma once
+
+#include "MeshData.h"
+#include "ofPixels.h"
+#include "ofRectangle.h"
+#include <thread>
+#include <algorithm>
+
+// what the blend pass does to each pixel, baked as a 16 bit gain per channel.
+// pixels covered by no mesh get 0 and come out black, as on screen.
+class BlendMask
+{
+public:
+	using Params = ofxBlendScreen::Shader::Params;
+	// a separate default constructor, since an explicit one can't be left out of an aggregate initializer
+	BlendMask():BlendMask(std::max(1u, std::thread::hardware_concurrency())) {}
+	explicit BlendMask(std::size_t num_threads):num_threads_(std::max<std::size_t>(1, num_threads)) {}
+	// the whole bridge as the editor shows it: where meshes overlap the one drawn last wins.
+	// with bake off nothing bridge sized is kept and getMask() computes the rect it is asked for,
+	// for exports that go tile by tile through huge bridges. apply() needs it baked.
+	void setup(const BlendingData &data, const glm::ivec2 &size, bool bake=true);
+	// one projector's own ramps over its output rect(see getOutputRect), whatever else overlaps it.
+	// the mask is the rect's size and apply()/getMask() take images and rects relative to it.
+	void setup(const BlendingMesh &mesh, const Params &params, const glm::ivec2 &bridge_resolution, bool bake=true);
+	// multiplies an 8 bit rgb(a) image of the mask's size in place. alpha is left as it is.
+	void apply(ofPixels &pixels) const;
+	// the gains in rect as a 16 bit rgb image, for playback that multiplies instead of running the shader.
+	// base_color is not in it since it isn't a multiplier.
+	void getMask(ofShortPixels &dst, const ofRectangle &rect) const;
+	void getMask(ofShortPixels &dst) const { getMask(dst, {0, 0, (float)size_.x, (float)size_.y}); }
+	glm::ivec2 getSize() const { return size_; }
+
+	// the part of the bridge a blending mesh shows, in whole pixels
+	static ofRectangle getOutputRect(const BlendingMesh &mesh, const glm::ivec2 &bridge_resolution);
+private:
+	// where the inner quad's corners sit in the outer quad's normalized space
+	struct Shape {
+		geom::Quad outer;
+		glm::vec2 lt, rt, lb, rb;
+		bool l, r, t, b;
+	};
+	static Shape getShape(const BlendingMesh &mesh);
+	// overlap positions of point in shape, false if it's outside
+	static bool getPosition(const Shape &shape, glm::vec2 point, glm::vec2 &result);
+	void setupGains(const Params &params, const glm::ivec2 &size, bool bake);
+	// gains of columns [x0,x1) of rows [y0,y1), rows stride values apart
+	void compute(int x0, int y0, int x1, int y1, std::uint16_t *dst, std::size_t stride) const;
+
+	std::size_t num_threads_;
+	glm::ivec2 size_;
+	glm::vec2 offset_;	// where the mask's top left sits in the bridge
+	std::vector<Shape> shapes_;
+	Params params_;
+	std::vector<std::uint16_t> gain_;	// rgb interleaved, empty unless baked
+	std::uint16_t lift_[3][256];	// source values with base_color applied, scaled by 256
+};
@@ -0,0 +1,74 @@
+#include "BlendShaderCheck.h"
+#include "BlendFunction.h"
+#include "MeshData.h"
+#include "ofFbo.h"
+#include "ofGraphics.h"
+
+BlendShaderCheck checkBlendShader(ofxBlendScreen::Shader &shader, int size)
+{
+	BlendShaderCheck ret;
+	ret.size = size;
+	// inner quad pushed into the right bottom corner, so x and y run 0 to 1 across the whole mesh
+	BlendingMesh mesh;
+	mesh.init({0, 0, (float)size, (float)size}, 1);
+	mesh.mesh->quad[1] = ofRectangle(size, size, 0, 0);
+	mesh.blend_r = mesh.blend_b = false;
+
+	// a white source comes out as the gain itself; base_color only lifts what is below white
+	ofFloatPixels white;
+	white.allocate(size, size, OF_PIXELS_RGBA);
+	white.set(1);
+	ofTexture tex;
+	tex.allocate(white);
+	tex.loadData(white);
+	auto tex_data = tex.getTextureData();
+	glm::vec2 tex_scale = tex_data.textureTarget == GL_TEXTURE_RECTANGLE_ARB
+	? glm::vec2(1,1)
+	: glm::vec2(1/tex_data.tex_w, 1/tex_data.tex_h);
+
+	ofFbo::Settings settings;
+	settings.width = settings.height = size;
+	settings.internalformat = GL_RGBA32F;
+	ofFbo fbo;
+	fbo.allocate(settings);
+	if(!fbo.isAllocated()) {
+		return ret;
+	}
+	fbo.begin();
+	ofClear(0, 0);
+	ofPushStyle();
+	ofEnableBlendMode(OF_BLENDMODE_DISABLED);
+	shader.begin(tex);
+	tex.bind();
+	mesh.createMesh(size, tex_scale).draw();
+	tex.unbind();
+	shader.end();
+	ofPopStyle();
+	fbo.end();
+	ofFloatPixels pixels;
+	fbo.readToPixels(pixels);
+	const std::size_t channels = pixels.getNumChannels();
+
+	std::vector<float> x(size), y(size), gain(size*3);
+	for(int col = 0; col < size; ++col) {
+		x[col] = (col+0.5f)/size;
+	}
+	for(int row = 0; row < size; ++row) {
+		std::fill(begin(y), end(y), (row+0.5f)/size);
+		blend::gain(x.data(), y.data(), size, shader.getParams(), gain.data());
+		const float *src = pixels.getData() + std::size_t(row)*size*channels;
+		for(int col = 0; col < size; ++col) {
+			for(int c = 0; c < 3; ++c) {
+				int steps = (int)std::round(std::abs(src[col*channels+c]-gain[c*size+col])*65535);
+				if(steps > ret.max_steps) {
+					ret.max_steps = steps;
+					ret.worst = {col, row};
+					ret.gpu = {src[col*channels], src[col*channels+1], src[col*channels+2]};
+					ret.cpu = {gain[col], gain[size+col], gain[size*2+col]};
+				}
+			}
+		}
+	}
+	ret.is_done = true;
+	return ret;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ofxBlendScreen.h"
+
+// blend::gain stands in for ofxBlendScreen::Shader wherever there is no GL context(BlendMask, UVMap, the cli),
+// so this renders the shader's ramps into a float fbo and reads them back to see that both still agree.
+// the overlaps cover the whole target left to right and top to bottom, so every pixel is compared on a ramp
+// and the crossing of two overlaps is compared everywhere. needs the GL thread.
+struct BlendShaderCheck {
+	bool is_done=false;	// false if the fbo couldn't be made
+	int size=0;
+	int max_steps=0;	// largest difference in 65535ths
+	glm::ivec2 worst;	// pixel where it is
+	glm::vec3 gpu, cpu;	// the gains there
+
+	bool isMatch(int tolerance=1) const { return is_done && max_steps <= tolerance; }
+};
+BlendShaderCheck checkBlendShader(ofxBlendScreen::Shader &shader, int size=256);
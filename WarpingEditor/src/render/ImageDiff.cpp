@@ -0,0 +1,41 @@
+#include "ImageDiff.h"
+#include <cmath>
+#include <limits>
+#include <cstdlib>
+
+ImageDiff compareImages(const ofPixels &a, const ofPixels &b, int tolerance, ofPixels *diff)
+{
+	ImageDiff ret;
+	ret.is_same_shape = a.getWidth() == b.getWidth()
+	&& a.getHeight() == b.getHeight()
+	&& a.getNumChannels() == b.getNumChannels();
+	if(!ret.is_same_shape) {
+		return ret;
+	}
+	const std::size_t channels = a.getNumChannels();
+	ret.num_pixels = a.getWidth()*a.getHeight();
+	if(diff) {
+		diff->allocate(a.getWidth(), a.getHeight(), a.getPixelFormat());
+	}
+	const unsigned char *pa = a.getData(), *pb = b.getData();
+	double squared_sum = 0;
+	for(std::size_t i = 0; i < ret.num_pixels; ++i) {
+		bool is_mismatched = false;
+		for(std::size_t c = 0; c < channels; ++c) {
+			std::size_t index = i*channels+c;
+			int error = std::abs(pa[index]-pb[index]);
+			squared_sum += error*error;
+			ret.max_error = std::max(ret.max_error, error);
+			is_mismatched |= error > tolerance;
+			if(diff) {
+				diff->getData()[index] = std::min(255, error*16);
+			}
+		}
+		if(is_mismatched) {
+			++ret.num_mismatched;
+		}
+	}
+	double mse = ret.num_pixels > 0 ? squared_sum/(ret.num_pixels*channels) : 0;
+	ret.psnr = mse > 0 ? 10*std::log10(255*255/mse) : std::numeric_limits<double>::infinity();
+	return ret;
+}
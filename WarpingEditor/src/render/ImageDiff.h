@@ -0,0 +1,17 @@
+#pragma once
+
+#include "ofPixels.h"
+
+// compares two renders channel by channel, for checking outputs against golden images.
+struct ImageDiff {
+	bool is_same_shape=false;	// width, height and channels match; nothing else is valid otherwise
+	std::size_t num_pixels=0;
+	std::size_t num_mismatched=0;	// pixels with any channel off by more than the tolerance
+	int max_error=0;
+	double psnr=0;	// infinity when identical
+
+	bool isMatch() const { return is_same_shape && num_mismatched == 0; }
+};
+
+// diff, if given, receives the absolute differences scaled up to be visible.
+ImageDiff compareImages(const ofPixels &a, const ofPixels &b, int tolerance=0, ofPixels *diff=nullptr);
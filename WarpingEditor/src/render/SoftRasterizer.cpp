@@ -0,0 +1,242 @@
+#include "SoftRasterizer.h"
+#include "ofLog.h"
+#include <atomic>
+#include <cmath>
+
+namespace {
+struct Triangle {
+	// edge functions e_i(x,y) = a[i]*x + b[i]*y + c[i], each one the weight of vertex i scaled by the area
+	double a[3], b[3], c[3];
+	bool is_inclusive[3];
+	float inv_area;
+	glm::vec2 uv[3];
+	glm::vec4 color[3];
+	int x0, y0, x1, y1;	// covered pixels, [x0,x1)x[y0,y1)
+};
+
+bool setupTriangle(const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2,
+				   const glm::vec2 &t0, const glm::vec2 &t1, const glm::vec2 &t2,
+				   const glm::vec4 &c0, const glm::vec4 &c1, const glm::vec4 &c2,
+				   int width, int height, Triangle &dst)
+{
+	glm::dvec2 p[3] = {{v0.x,v0.y}, {v1.x,v1.y}, {v2.x,v2.y}};
+	dst.uv[0] = t0; dst.uv[1] = t1; dst.uv[2] = t2;
+	dst.color[0] = c0; dst.color[1] = c1; dst.color[2] = c2;
+	double area = (p[1].x-p[0].x)*(p[2].y-p[0].y) - (p[1].y-p[0].y)*(p[2].x-p[0].x);
+	if(area == 0 || !std::isfinite(area)) {
+		return false;
+	}
+	// no culling in GL either; flip to one winding so the fill rule below holds for both
+	if(area < 0) {
+		std::swap(p[1], p[2]);
+		std::swap(dst.uv[1], dst.uv[2]);
+		std::swap(dst.color[1], dst.color[2]);
+		area = -area;
+	}
+	for(int i = 0; i < 3; ++i) {
+		const glm::dvec2 &s = p[(i+1)%3], &e = p[(i+2)%3];
+		dst.a[i] = -(e.y-s.y);
+		dst.b[i] = e.x-s.x;
+		dst.c[i] = (e.y-s.y)*s.x - (e.x-s.x)*s.y;
+		// pixels exactly on an edge shared by two triangles belong to only one of them
+		dst.is_inclusive[i] = e.y-s.y < 0 || (e.y == s.y && e.x-s.x > 0);
+	}
+	dst.inv_area = 1/area;
+	auto minmax = std::minmax({p[0].x, p[1].x, p[2].x});
+	dst.x0 = std::max(0, (int)std::floor(minmax.first));
+	dst.x1 = std::min(width, (int)std::ceil(minmax.second)+1);
+	minmax = std::minmax({p[0].y, p[1].y, p[2].y});
+	dst.y0 = std::max(0, (int)std::floor(minmax.first));
+	dst.y1 = std::min(height, (int)std::ceil(minmax.second)+1);
+	return dst.x0 < dst.x1 && dst.y0 < dst.y1;
+}
+
+// bilinear, clamped to edge; rgba in 0-1 whatever the channels of src
+glm::vec4 sample(const ofPixels &src, glm::vec2 uv) {
+	const int w = src.getWidth(), h = src.getHeight();
+	const int channels = src.getNumChannels();
+	float fx = uv.x*w-0.5f, fy = uv.y*h-0.5f;
+	float flx = std::floor(fx), fly = std::floor(fy);
+	float rx = fx-flx, ry = fy-fly;
+	int x0 = std::max(0, std::min(w-1, (int)flx)), x1 = std::max(0, std::min(w-1, (int)flx+1));
+	int y0 = std::max(0, std::min(h-1, (int)fly)), y1 = std::max(0, std::min(h-1, (int)fly+1));
+	const unsigned char *data = src.getData();
+	const unsigned char *p00 = data+((std::size_t)y0*w+x0)*channels, *p10 = data+((std::size_t)y0*w+x1)*channels;
+	const unsigned char *p01 = data+((std::size_t)y1*w+x0)*channels, *p11 = data+((std::size_t)y1*w+x1)*channels;
+	float ret[4] = {0,0,0,1};
+	for(int c = 0; c < channels && c < 4; ++c) {
+		float top = p00[c] + (p10[c]-p00[c])*rx;
+		float bottom = p01[c] + (p11[c]-p01[c])*rx;
+		ret[c] = (top + (bottom-top)*ry)/255.f;
+	}
+	switch(channels) {
+		case 1: return {ret[0], ret[0], ret[0], 1};
+		case 2: return {ret[0], ret[0], ret[0], ret[1]};
+		default: return {ret[0], ret[1], ret[2], ret[3]};
+	}
+}
+
+void blendTo(unsigned char *dst, int channels, const glm::vec4 &src) {
+	auto mix = [a=src.a](unsigned char d, float s) {
+		float v = s*a + d/255.f*(1-a);
+		return (unsigned char)std::max(0.f, std::min(255.f, v*255+0.5f));
+	};
+	switch(channels) {
+		case 1: dst[0] = mix(dst[0], (src.r+src.g+src.b)/3); break;
+		case 2: dst[0] = mix(dst[0], (src.r+src.g+src.b)/3); dst[1] = mix(dst[1], src.a); break;
+		default:
+			dst[0] = mix(dst[0], src.r);
+			dst[1] = mix(dst[1], src.g);
+			dst[2] = mix(dst[2], src.b);
+			if(channels > 3) dst[3] = mix(dst[3], src.a);
+			break;
+	}
+}
+
+template<typename SpanFunc>
+void rasterizeTriangle(const Triangle &tri, int tx0, int ty0, int tx1, int ty1, SpanFunc &&span) {
+	const int x0 = std::max(tri.x0, tx0), x1 = std::min(tri.x1, tx1);
+	const int y0 = std::max(tri.y0, ty0), y1 = std::min(tri.y1, ty1);
+	SoftRasterizer::Span result;
+	result.uv_step = (tri.uv[0]*tri.a[0] + tri.uv[1]*tri.a[1] + tri.uv[2]*tri.a[2])*tri.inv_area;
+	result.color_step = (tri.color[0]*tri.a[0] + tri.color[1]*tri.a[1] + tri.color[2]*tri.a[2])*tri.inv_area;
+	for(int y = y0; y < y1; ++y) {
+		const double py = y+0.5;
+		double e[3], step[3];
+		for(int i = 0; i < 3; ++i) {
+			e[i] = tri.a[i]*(x0+0.5) + tri.b[i]*py + tri.c[i];
+			step[i] = tri.a[i];
+		}
+		// triangles are convex, so the covered pixels of a row are one run
+		int begin = x1, end = x1;
+		double e_begin[3];
+		for(int x = x0; x < x1; ++x) {
+			bool inside = true;
+			for(int i = 0; i < 3; ++i) {
+				inside &= e[i] > 0 || (e[i] == 0 && tri.is_inclusive[i]);
+			}
+			if(inside && begin == x1) {
+				begin = x;
+				std::copy_n(e, 3, e_begin);
+			}
+			else if(!inside && begin != x1) {
+				end = x;
+				break;
+			}
+			for(int i = 0; i < 3; ++i) {
+				e[i] += step[i];
+			}
+		}
+		if(begin == x1) {
+			continue;
+		}
+		float w0 = e_begin[0]*tri.inv_area, w1 = e_begin[1]*tri.inv_area, w2 = e_begin[2]*tri.inv_area;
+		result.y = y;
+		result.x0 = begin;
+		result.x1 = end;
+		result.uv = tri.uv[0]*w0 + tri.uv[1]*w1 + tri.uv[2]*w2;
+		result.color = tri.color[0]*w0 + tri.color[1]*w1 + tri.color[2]*w2;
+		span(result);
+	}
+}
+
+// triangle setup, binning into tiles and running the tiles on the threads
+template<typename SpanFunc>
+void rasterizeMesh(const ofMesh &mesh, int clip_x0, int clip_y0, int clip_x1, int clip_y1, std::size_t max_threads, SpanFunc &&span) {
+	if(mesh.getMode() != OF_PRIMITIVE_TRIANGLES) {
+		ofLogError("SoftRasterizer") << "only triangles are supported";
+		return;
+	}
+	if(clip_x0 >= clip_x1 || clip_y0 >= clip_y1) {
+		return;
+	}
+	const auto &vertices = mesh.getVertices();
+	const auto &texcoords = mesh.getTexCoords();
+	const auto &colors = mesh.getColors();
+	bool has_texcoords = texcoords.size() == vertices.size();
+	bool has_colors = colors.size() == vertices.size();
+	std::size_t num_indices = mesh.hasIndices() ? mesh.getNumIndices() : vertices.size();
+	auto index = [&](std::size_t i) -> std::size_t { return mesh.hasIndices() ? mesh.getIndex(i) : i; };
+	auto uv = [&](std::size_t i) { return has_texcoords ? texcoords[i] : glm::vec2{0,0}; };
+	auto color = [&](std::size_t i) { return has_colors ? glm::vec4{colors[i].r, colors[i].g, colors[i].b, colors[i].a} : glm::vec4{1,1,1,1}; };
+
+	const int width = clip_x1-clip_x0, height = clip_y1-clip_y0;
+	std::vector<Triangle> triangles;
+	triangles.reserve(num_indices/3);
+	for(std::size_t i = 0; i+2 < num_indices; i += 3) {
+		std::size_t i0 = index(i), i1 = index(i+1), i2 = index(i+2);
+		if(i0 >= vertices.size() || i1 >= vertices.size() || i2 >= vertices.size()) {
+			continue;
+		}
+		// set up relative to the clip, so tiles start at 0
+		glm::vec3 offset(clip_x0, clip_y0, 0);
+		Triangle tri;
+		if(setupTriangle(vertices[i0]-offset, vertices[i1]-offset, vertices[i2]-offset, uv(i0), uv(i1), uv(i2), color(i0), color(i1), color(i2), width, height, tri)) {
+			triangles.push_back(tri);
+		}
+	}
+
+	// bin triangles into tiles by their bounds, keeping mesh order
+	const int tile_size = SoftRasterizer::TILE_SIZE;
+	const int cols = (width+tile_size-1)/tile_size, rows = (height+tile_size-1)/tile_size;
+	std::vector<std::vector<std::size_t>> bins(cols*rows);
+	for(std::size_t i = 0; i < triangles.size(); ++i) {
+		auto &&t = triangles[i];
+		for(int row = t.y0/tile_size; row <= (t.y1-1)/tile_size; ++row) {
+			for(int col = t.x0/tile_size; col <= (t.x1-1)/tile_size; ++col) {
+				bins[row*cols+col].push_back(i);
+			}
+		}
+	}
+
+	std::atomic<std::size_t> next_tile{0};
+	auto work = [&]() {
+		std::size_t tile;
+		while((tile = next_tile++) < bins.size()) {
+			int tx0 = (tile%cols)*tile_size, ty0 = (tile/cols)*tile_size;
+			int tx1 = std::min(width, tx0+tile_size), ty1 = std::min(height, ty0+tile_size);
+			for(auto &&i : bins[tile]) {
+				rasterizeTriangle(triangles[i], tx0, ty0, tx1, ty1, [&](SoftRasterizer::Span s) {
+					s.y += clip_y0;
+					s.x0 += clip_x0;
+					s.x1 += clip_x0;
+					span(s);
+				});
+			}
+		}
+	};
+	std::size_t num_threads = std::min(max_threads, bins.size());
+	std::vector<std::thread> threads;
+	for(std::size_t i = 1; i < num_threads; ++i) {
+		threads.emplace_back(work);
+	}
+	work();
+	for(auto &&t : threads) {
+		t.join();
+	}
+}
+}
+
+void SoftRasterizer::draw(const ofMesh &mesh, const ofPixels &src, ofPixels &dst) const
+{
+	if(!dst.isAllocated() || !src.isAllocated()) {
+		return;
+	}
+	const int channels = dst.getNumChannels();
+	const std::size_t stride = dst.getWidth()*channels;
+	unsigned char *data = dst.getData();
+	rasterizeMesh(mesh, 0, 0, dst.getWidth(), dst.getHeight(), num_threads_, [&](const Span &span) {
+		unsigned char *row = data + span.y*stride;
+		for(int x = span.x0; x < span.x1; ++x) {
+			float t = x-span.x0;
+			blendTo(row + x*channels, channels, sample(src, span.uv+span.uv_step*t)*(span.color+span.color_step*t));
+		}
+	});
+}
+
+void SoftRasterizer::rasterize(const ofMesh &mesh, const ofRectangle &clip, const std::function<void(const Span&)> &span) const
+{
+	int x0 = std::floor(clip.getLeft()), y0 = std::floor(clip.getTop());
+	int x1 = std::ceil(clip.getRight()), y1 = std::ceil(clip.getBottom());
+	rasterizeMesh(mesh, x0, y0, x1, y1, num_threads_, span);
+}
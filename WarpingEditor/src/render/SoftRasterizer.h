@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ofMesh.h"
+#include "ofPixels.h"
+#include "ofRectangle.h"
+#include <functional>
+#include <thread>
+#include <algorithm>
+
+// draws textured triangle meshes into pixels on the CPU, the way GuiApp draws the bridge into its fbo.
+// for places without a GL context: batch rendering and checking results on build servers.
+// the target is split into tiles rendered in parallel. within a tile triangles keep mesh order,
+// so the result doesn't depend on the number of threads.
+class SoftRasterizer
+{
+public:
+	static constexpr int TILE_SIZE = 64;
+	explicit SoftRasterizer(std::size_t num_threads=std::max(1u, std::thread::hardware_concurrency()))
+	:num_threads_(std::max<std::size_t>(1, num_threads)) {}
+
+	// vertices in dst pixels, texcoords normalized to src(as with ofDisableArbTex).
+	// vertex colors, if any, multiply the texel. the result is alpha blended over dst like
+	// OF's default blend mode, so opaque sources simply overwrite.
+	// only OF_PRIMITIVE_TRIANGLES is supported, indexed or not.
+	void draw(const ofMesh &mesh, const ofPixels &src, ofPixels &dst) const;
+
+	// a run of covered pixels in a row, with the attributes interpolated across it
+	struct Span {
+		int y, x0, x1;	// pixels [x0,x1) of row y
+		glm::vec2 uv, uv_step;	// at the center of x0 and per pixel, so at x it is uv+uv_step*(x-x0)
+		glm::vec4 color, color_step;
+	};
+	// for anything other than sampling a texture: calls span for every covered run inside clip.
+	// runs on the worker threads, but a pixel is only ever visited by one thread, and in mesh order.
+	void rasterize(const ofMesh &mesh, const ofRectangle &clip, const std::function<void(const Span&)> &span) const;
+	std::size_t getNumThreads() const { return num_threads_; }
+private:
+	std::size_t num_threads_;
+};
@@ -0,0 +1,128 @@
+#include "UVMap.h"
+#include "BlendMask.h"
+#include "Bytes.h"
+#include "ofImage.h"
+#include "ofLog.h"
+#include <fstream>
+
+namespace {
+std::uint16_t toUnorm16(float v) {
+	return v == UVMap::NO_MESH ? 65535 : (std::uint16_t)std::round(std::max(0.f, std::min(1.f, v))*65534);
+}
+}
+
+void UVMap::setup(const ofMesh &warped, const glm::ivec2 &size, const BlendMask *blend)
+{
+	mesh_ = warped;
+	size_ = size;
+	blend_ = blend;
+}
+
+void UVMap::render(const ofRectangle &rect, std::vector<float> &uv) const
+{
+	const int x0 = rect.x, y0 = rect.y, width = rect.width;
+	uv.assign(std::size_t(rect.width)*rect.height*2, NO_MESH);
+	// meshes later in order overwrite, as when drawn
+	rasterizer_.rasterize(mesh_, rect, [&](const SoftRasterizer::Span &span) {
+		float *dst = uv.data() + (std::size_t(span.y-y0)*width + span.x0-x0)*2;
+		for(int x = span.x0; x < span.x1; ++x) {
+			auto value = span.uv + span.uv_step*float(x-span.x0);
+			*dst++ = value.x;
+			*dst++ = value.y;
+		}
+	});
+}
+
+bool UVMap::saveRaw(const std::filesystem::path &filepath, Format format, int band_rows) const
+{
+	std::ofstream file(filepath, std::ios::binary);
+	if(!file) {
+		ofLogError("UVMap") << "failed to open: " << filepath;
+		return false;
+	}
+	const std::uint32_t channels = blend_ ? 5 : 2;
+	ByteWriter writer;
+	writer.putBytes("UVLT", 4);
+	std::uint32_t header[] = {1, (std::uint32_t)size_.x, (std::uint32_t)size_.y, (std::uint32_t)format, channels, 0, 0};
+	writer.putArray(header, 7, 1);
+	file.write(writer.data(), writer.size());
+
+	band_rows = std::max(1, band_rows);
+	std::vector<float> uv, values;
+	std::vector<std::uint16_t> values16;
+	ofShortPixels gains;
+	for(int y = 0; y < size_.y && file; y += band_rows) {
+		ofRectangle band(0, y, size_.x, std::min(band_rows, size_.y-y));
+		render(band, uv);
+		if(blend_) {
+			blend_->getMask(gains, band);
+		}
+		std::size_t num_pixels = uv.size()/2;
+		writer.clear();
+		if(format == FLOAT32) {
+			values.resize(num_pixels*channels);
+			for(std::size_t i = 0; i < num_pixels; ++i) {
+				values[i*channels] = uv[i*2];
+				values[i*channels+1] = uv[i*2+1];
+				for(std::size_t c = 2; c < channels; ++c) {
+					values[i*channels+c] = gains.getData()[i*3+c-2]/65535.f;
+				}
+			}
+			writer.putArray(values.data(), values.size(), 1);
+		}
+		else {
+			values16.resize(num_pixels*channels);
+			for(std::size_t i = 0; i < num_pixels; ++i) {
+				values16[i*channels] = toUnorm16(uv[i*2]);
+				values16[i*channels+1] = toUnorm16(uv[i*2+1]);
+				for(std::size_t c = 2; c < channels; ++c) {
+					values16[i*channels+c] = gains.getData()[i*3+c-2];
+				}
+			}
+			writer.putArray(values16.data(), values16.size(), 1);
+		}
+		file.write(writer.data(), writer.size());
+	}
+	if(!file) {
+		ofLogError("UVMap") << "failed to write: " << filepath;
+		return false;
+	}
+	return true;
+}
+
+bool UVMap::savePng(const std::filesystem::path &filepath_base, int tile_size) const
+{
+	tile_size = std::max(1, tile_size);
+	bool is_tiled = size_.x > tile_size || size_.y > tile_size;
+	std::vector<float> uv;
+	bool succeeded = true;
+	auto save = [&](const ofShortPixels &pixels, const std::string &suffix) {
+		auto path = filepath_base.string()+suffix+".png";
+		if(!ofSaveImage(pixels, path)) {
+			ofLogError("UVMap") << "failed to write: " << path;
+			succeeded = false;
+		}
+	};
+	for(int y = 0; y < size_.y; y += tile_size) {
+		for(int x = 0; x < size_.x; x += tile_size) {
+			ofRectangle tile(x, y, std::min(tile_size, size_.x-x), std::min(tile_size, size_.y-y));
+			render(tile, uv);
+			ofShortPixels u, v;
+			u.allocate(tile.width, tile.height, OF_PIXELS_GRAY);
+			v.allocate(tile.width, tile.height, OF_PIXELS_GRAY);
+			for(std::size_t i = 0; i < uv.size()/2; ++i) {
+				u.getData()[i] = toUnorm16(uv[i*2]);
+				v.getData()[i] = toUnorm16(uv[i*2+1]);
+			}
+			std::string suffix = is_tiled ? "_"+ofToString(x)+"_"+ofToString(y) : "";
+			save(u, "_u"+suffix);
+			save(v, "_v"+suffix);
+			if(blend_) {
+				ofShortPixels gains;
+				blend_->getMask(gains, tile);
+				save(gains, "_blend"+suffix);
+			}
+		}
+	}
+	return succeeded;
+}
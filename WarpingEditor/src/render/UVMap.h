@@ -0,0 +1,41 @@
+#pragma once
+
+#include "SoftRasterizer.h"
+#include <filesystem>
+
+class BlendMask;
+
+/*
+ per output pixel texture coordinates of a warp, for media servers that remap instead of drawing meshes.
+ raw:	char magic[4]="UVLT", uint32 version(=1), uint32 width, uint32 height,
+		uint32 format(0: float32, 1: unorm16), uint32 channels(2: u,v  5: u,v,r,g,b), uint32 reserved[2]
+		then rows top to bottom, channels interleaved, little endian.
+		uv are normalized to the texture. float32 has -1 where no mesh covers the pixel;
+		unorm16 stores round(uv*65534) and 65535 there. blend gains are 0-1, or 0-65535 in unorm16.
+ png:	<name>_u.png and <name>_v.png, 16 bit gray in the unorm16 encoding, and <name>_blend.png(16 bit rgb)
+		if a blend is given. outputs larger than a tile are split into <name>_u_<x>_<y>.png and so on,
+		x and y being the tile's offset in pixels.
+ */
+class UVMap
+{
+public:
+	enum Format {
+		FLOAT32, UNORM16
+	};
+	static constexpr float NO_MESH = -1;
+	explicit UVMap(std::size_t num_threads=std::max(1u, std::thread::hardware_concurrency()))
+	:rasterizer_(num_threads) {}
+	// vertices in output pixels, texcoords normalized(see WarpingData::getMeshForExport).
+	// blend is optional, of the same size and kept by the caller.
+	void setup(const ofMesh &warped, const glm::ivec2 &size, const BlendMask *blend=nullptr);
+	// rendered and written band by band, so huge outputs don't have to fit in memory
+	bool saveRaw(const std::filesystem::path &filepath, Format format, int band_rows=1024) const;
+	bool savePng(const std::filesystem::path &filepath_base, int tile_size=8192) const;
+	// uv pairs of the pixels in rect, NO_MESH where nothing is drawn
+	void render(const ofRectangle &rect, std::vector<float> &uv) const;
+private:
+	ofMesh mesh_;
+	glm::ivec2 size_;
+	const BlendMask *blend_=nullptr;
+	SoftRasterizer rasterizer_;
+};
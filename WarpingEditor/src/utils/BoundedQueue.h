@@ -0,0 +1,49 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+// hands items from one pipeline stage to the next; the producer blocks while it's full.
+// after close(), push fails and pop drains what is left before failing.
+template<typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(std::size_t capacity):capacity_(std::max<std::size_t>(1, capacity)) {}
+
+	bool push(T &&item) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		not_full_.wait(lock, [this]{ return is_closed_ || items_.size() < capacity_; });
+		if(is_closed_) {
+			return false;
+		}
+		items_.push_back(std::move(item));
+		not_empty_.notify_one();
+		return true;
+	}
+	bool pop(T &item) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		not_empty_.wait(lock, [this]{ return is_closed_ || !items_.empty(); });
+		if(items_.empty()) {
+			return false;
+		}
+		item = std::move(items_.front());
+		items_.pop_front();
+		not_full_.notify_one();
+		return true;
+	}
+	void close() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		is_closed_ = true;
+		not_full_.notify_all();
+		not_empty_.notify_all();
+	}
+private:
+	std::size_t capacity_;
+	std::deque<T> items_;
+	std::mutex mutex_;
+	std::condition_variable not_full_, not_empty_;
+	bool is_closed_=false;
+};
@@ -2,7 +2,11 @@
 #include "ofImage.h"
 #include "ofFileUtils.h"
 #include "ofUtils.h"
-#include "ofVideoPlayer.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "ThreadPool.h"
+#include "TiledTexture.h"
 
 namespace {
 class ImageFile : public ImageSourceImpl {
@@ -10,54 +14,290 @@ public:
 	bool load(const std::filesystem::path &filepath) {
 		return ofLoadImage(texture_, filepath);
 	}
-	ofTexture& getTexture() override { return texture_; }
-	const ofTexture& getTexture() const override { return texture_; };
+	bool loadAsync(const std::filesystem::path &filepath) {
+		if(!ofFile::doesFileExist(filepath.string(), false)) {
+			ofLogError("ImageFile") << "file not found: " << filepath;
+			return false;
+		}
+		GLint max_texture_size = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+		std::size_t tiling_threshold = std::min<std::size_t>(max_texture_size, TILING_THRESHOLD);
+		decoding_ = std::make_shared<Decoding>();
+		// the worker only touches the shared state, so dropping this source mid-decode doesn't wait for it
+		std::thread([decoding=decoding_, filepath, tiling_threshold]() {
+			ofPixels pixels;
+			bool succeeded = ofLoadImage(pixels, filepath);
+			std::vector<ofPixels> levels;
+			if(succeeded && std::max(pixels.getWidth(), pixels.getHeight()) > tiling_threshold) {
+				levels = TiledTexture::buildPyramid(std::move(pixels));
+			}
+			std::lock_guard<std::mutex> lock(decoding->mutex);
+			decoding->pixels = std::move(pixels);
+			decoding->levels = std::move(levels);
+			decoding->state = succeeded ? Decoding::DECODED : Decoding::FAILED;
+			if(!succeeded) {
+				ofLogError("ImageFile") << "failed to decode: " << filepath;
+			}
+		}).detach();
+		return true;
+	}
+	void update() override {
+		is_frame_new_ = false;
+		if(decoding_ && decoding_->state == Decoding::DECODED) {
+			std::lock_guard<std::mutex> lock(decoding_->mutex);
+			if(decoding_->levels.empty()) {
+				// one upload on the GL thread, then the pixels are no longer needed
+				texture_.loadData(decoding_->pixels);
+				is_frame_new_ = true;
+			}
+			else {
+				tiled_ = std::make_unique<TiledTexture>();
+				tiled_->setup(std::move(decoding_->levels));
+			}
+			decoding_ = nullptr;
+		}
+		if(tiled_ && tiled_->update(region_of_interest_, region_scale_)) {
+			is_frame_new_ = true;
+		}
+	}
+	void setRegionOfInterest(const ofRectangle &region, float scale) override {
+		region_of_interest_ = region;
+		region_scale_ = scale;
+	}
+	bool isFrameNew() const override { return is_frame_new_; }
+	bool isReady() const override { return !decoding_; }
+	bool isFailed() const override { return decoding_ && decoding_->state == Decoding::FAILED; }
+	ofTexture& getTexture() override { return tiled_ ? tiled_->getTexture() : texture_; }
+	const ofTexture& getTexture() const override { return tiled_ ? tiled_->getTexture() : texture_; };
 protected:
+	// larger stills are shown through a TiledTexture
+	static constexpr std::size_t TILING_THRESHOLD = 8192;
 	ofTexture texture_;
+	std::unique_ptr<TiledTexture> tiled_;
+	ofRectangle region_of_interest_;
+	float region_scale_=1;
+	struct Decoding {
+		enum State { DECODING, DECODED, FAILED };
+		std::atomic<int> state{DECODING};
+		std::mutex mutex;
+		ofPixels pixels;
+		std::vector<ofPixels> levels;
+	};
+	std::shared_ptr<Decoding> decoding_;
+	bool is_frame_new_=false;
 };
 class VideoFile : public ImageSourceImpl {
 public:
 	bool load(const std::filesystem::path &filepath) {
-		player_.setUseTexture(true);
-		bool ret = player_.load(filepath.string());
-		player_.setLoopState(OF_LOOP_NORMAL);
-		player_.play();
-		return ret;
+		uploader_.setup();
+		is_started_ = false;
+		return decoder_.load(filepath);
 	}
 	void update() override {
-		player_.update();
+		// the clock starts with the first frame so decoder warm-up doesn't count as lateness
+		double now = ofGetElapsedTimef();
+		double clock = is_started_ ? now-start_time_ : 0;
+		if(decoder_.present(clock, pixels_)) {
+			if(!is_started_) {
+				start_time_ = now;
+				is_started_ = true;
+			}
+			uploader_.push(pixels_);
+		}
+		is_frame_new_ = uploader_.upload();
 	}
-	bool isFrameNew() const override { return player_.isFrameNew(); }
-	ofTexture& getTexture() override { return player_.getTexture(); }
-	const ofTexture& getTexture() const override { return player_.getTexture(); };
+	bool isFrameNew() const override { return is_frame_new_; }
+	bool getUploadStats(UploadRing::Stats &stats) const override { stats = uploader_.getStats(); return true; }
+	bool getDecodeStats(VideoDecoder::Stats &stats) const override { stats = decoder_.getStats(); return true; }
+	ofTexture& getTexture() override { return uploader_.getTexture(); }
+	const ofTexture& getTexture() const override { return uploader_.getTexture(); };
 private:
-	ofVideoPlayer player_;
+	VideoDecoder decoder_;
+	PixelUploader uploader_;
+	ofPixels pixels_;
+	double start_time_=0;
+	bool is_started_=false;
+	bool is_frame_new_=false;
+};
+
+// numbered stills in a folder played at a fixed rate.
+// the next frames are decoded ahead on a pool into a ring of slots whose pixels are reused,
+// frame n always lives in slot n%size so nothing is allocated while playing.
+class ImageSequence : public ImageSourceImpl {
+public:
+	bool load(const std::filesystem::path &folder, float fps, std::size_t num_slots=8) {
+		ofDirectory dir(folder.string());
+		if(!dir.isDirectory()) {
+			ofLogError("ImageSequence") << "not a folder: " << folder;
+			return false;
+		}
+		for(auto &&ext : {"png","jpg","jpeg","tif","tiff","bmp"}) {
+			dir.allowExt(ext);
+		}
+		dir.listDir();
+		dir.sort();
+		for(auto &&f : dir) {
+			files_.push_back(f.getAbsolutePath());
+		}
+		if(files_.empty()) {
+			ofLogError("ImageSequence") << "no image in: " << folder;
+			return false;
+		}
+		fps_ = fps > 0 ? fps : 30;
+		num_slots_ = std::max<std::size_t>(num_slots, 2);
+		slots_.reset(new Slot[num_slots_]);
+		uploader_.setup();
+		start_time_ = ofGetElapsedTimef();
+		prefetch(0);
+		return true;
+	}
+	void update() override {
+		std::int64_t frame = static_cast<std::int64_t>((ofGetElapsedTimef()-start_time_)*fps_);
+		prefetch(frame);
+		is_frame_new_ = false;
+		if(frame != presented_) {
+			auto &&slot = slots_[frame%num_slots_];
+			if(slot.frame == frame && slot.state == Slot::READY) {
+				uploader_.push(slot.pixels);
+				if(presented_ >= 0 && frame-presented_ > 1) {
+					stats_.late += frame-presented_-1;
+				}
+				presented_ = frame;
+				++stats_.presented;
+			}
+			else if(presented_ >= 0 && frame != missed_) {
+				// before the first frame nothing is due yet. a frame still loading counts once, not every update
+				++stats_.underrun;
+				missed_ = frame;
+			}
+		}
+		is_frame_new_ = uploader_.upload();
+	}
+	bool isFrameNew() const override { return is_frame_new_; }
+	bool getUploadStats(UploadRing::Stats &stats) const override { stats = uploader_.getStats(); return true; }
+	bool getDecodeStats(VideoDecoder::Stats &stats) const override {
+		stats = stats_;
+		stats.queue_capacity = num_slots_;
+		stats.queue_depth = 0;
+		for(std::size_t i = 0; i < num_slots_; ++i) {
+			if(slots_[i].state == Slot::READY && slots_[i].frame > presented_) {
+				++stats.queue_depth;
+			}
+		}
+		stats.decoded = decoded_;
+		return true;
+	}
+	ofTexture& getTexture() override { return uploader_.getTexture(); }
+	const ofTexture& getTexture() const override { return uploader_.getTexture(); };
+private:
+	struct Slot {
+		enum State { EMPTY, LOADING, READY };
+		std::atomic<int> state{EMPTY};
+		std::int64_t frame=-1;
+		ofPixels pixels;
+	};
+	std::vector<std::string> files_;
+	float fps_=30;
+	std::size_t num_slots_=0;
+	std::unique_ptr<Slot[]> slots_;
+	std::int64_t presented_=-1, missed_=-1;
+	double start_time_=0;
+	bool is_frame_new_=false;
+	PixelUploader uploader_;
+	VideoDecoder::Stats stats_;
+	std::atomic<std::uint64_t> decoded_{0};
+	// declared last so it is destroyed first and no task outlives the slots
+	ThreadPool pool_{std::min(4u, std::max(1u, std::thread::hardware_concurrency()))};
+
+	void prefetch(std::int64_t from) {
+		for(std::int64_t frame = from; frame < from+(std::int64_t)num_slots_; ++frame) {
+			auto &&slot = slots_[frame%num_slots_];
+			// a slot still loading holds an earlier frame that is about to be due; let it finish
+			if(slot.frame == frame || slot.state == Slot::LOADING) {
+				continue;
+			}
+			slot.frame = frame;
+			slot.state = Slot::LOADING;
+			auto filepath = files_[frame%files_.size()];
+			pool_.push([this, &slot, filepath]() {
+				// reloading into the same ofPixels keeps its allocation when the size matches
+				bool succeeded = ofLoadImage(slot.pixels, filepath);
+				if(!succeeded) {
+					ofLogError("ImageSequence") << "failed to decode: " << filepath;
+				}
+				++decoded_;
+				slot.state = succeeded ? Slot::READY : Slot::EMPTY;
+			});
+		}
+	}
 };
+
+bool isImageFile(const std::filesystem::path &filepath) {
+	return ofContains(std::vector<std::string>{"png","jpg","jpeg","tif","tiff","bmp","gif"}, ofToLower(ofFilePath::getFileExt(filepath)));
+}
+bool isVideoFile(const std::filesystem::path &filepath) {
+	return ofContains(std::vector<std::string>{"mov","mp4","mpg","wmv"}, ofToLower(ofFilePath::getFileExt(filepath)));
+}
+}
+
+void ImageSource::update()
+{
+	if(pending_) {
+		pending_->update();
+		if(pending_->isReady()) {
+			// swapped in on the frame its texture was uploaded, so isFrameNew() reports it
+			setImpl(pending_);
+			return;
+		}
+		if(pending_->isFailed()) {
+			pending_ = nullptr;
+		}
+	}
+	if(impl_) {
+		impl_->update();
+	}
 }
 
 bool ImageSource::loadFromFile(const std::filesystem::path &filepath)
 {
-	auto hasExt = [filepath](std::vector<std::string> ext) {
-		return ofContains(ext, ofFilePath::getFileExt(filepath));
-	};
-	bool is_image = hasExt({"png","jpg","jpeg","tif","tiff","bmp","gif"});
-	bool is_video = hasExt({"mov","mp4","mpg","wmv"});
-	if(is_image) {
+	if(isImageFile(filepath)) {
 		auto impl = std::make_shared<ImageFile>();
 		bool ret = impl->load(filepath);
 		if(ret) {
-			impl_ = impl;
+			setImpl(impl);
 		}
 		return ret;
 	}
-	if(is_video) {
+	if(isVideoFile(filepath)) {
 		auto impl = std::make_shared<VideoFile>();
 		bool ret = impl->load(filepath);
 		if(ret) {
-			impl_ = impl;
+			setImpl(impl);
 		}
 		return ret;
 	}
 	return false;
 }
 
+bool ImageSource::loadSequence(const std::filesystem::path &folder, float fps)
+{
+	auto impl = std::make_shared<ImageSequence>();
+	bool ret = impl->load(folder, fps);
+	if(ret) {
+		setImpl(impl);
+	}
+	return ret;
+}
+
+bool ImageSource::loadFromFileAsync(const std::filesystem::path &filepath)
+{
+	if(isImageFile(filepath)) {
+		auto impl = std::make_shared<ImageFile>();
+		bool ret = impl->loadAsync(filepath);
+		if(ret) {
+			pending_ = impl;
+		}
+		return ret;
+	}
+	return loadFromFile(filepath);
+}
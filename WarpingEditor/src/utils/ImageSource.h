@@ -3,14 +3,26 @@
 #include "ofGLBaseTypes.h"
 #include "ofUtils.h"
 #include "ofLog.h"
+#include "ofRectangle.h"
 #include "ofxNDIFinder.h"
 #include "ofxNDIVideoGrabber.h"
+#include "PixelUploader.h"
+#include "VideoDecoder.h"
 
 class ImageSourceImpl : public ofBaseHasTexture
 {
 public:
 	virtual void update() {}
 	virtual bool isFrameNew() const { return false; }
+	// false while an asynchronous load is still in progress
+	virtual bool isReady() const { return true; }
+	virtual bool isFailed() const { return false; }
+	// only sources streaming through a PixelUploader have these
+	virtual bool getUploadStats(UploadRing::Stats &stats) const { return false; }
+	virtual bool getDecodeStats(VideoDecoder::Stats &stats) const { return false; }
+	// the part of the image on screen(in image pixels, empty for all of it) and its screen pixels per image pixel.
+	// sources that can't hold everything at full resolution use it to pick what to upload.
+	virtual void setRegionOfInterest(const ofRectangle &region, float scale) {}
 	void setUseTexture(bool bUseTex) override { }
 	bool isUsingTexture() const override { return true; }
 };
@@ -19,18 +31,35 @@ class ImageSource : public ofBaseHasTexture
 {
 public:
 	bool loadFromFile(const std::filesystem::path &filepath);
+	// still images are decoded on a worker thread; the current texture stays until the new one is uploaded.
+	// returns false only if the file can't be loaded at all.
+	bool loadFromFileAsync(const std::filesystem::path &filepath);
+	// a folder of numbered stills, played in file name order
+	bool loadSequence(const std::filesystem::path &folder, float fps);
 	template<typename T>
 	bool setupNDI(T &&source);
-	void update() { impl_->update(); }
-	bool isFrameNew() const { return impl_->isFrameNew(); }
+	void update();
+	bool isFrameNew() const { return impl_ && impl_->isFrameNew(); }
+	bool isLoading() const { return pending_ != nullptr; }
+	bool getUploadStats(UploadRing::Stats &stats) const { return impl_ && impl_->getUploadStats(stats); }
+	bool getDecodeStats(VideoDecoder::Stats &stats) const { return impl_ && impl_->getDecodeStats(stats); }
+	void setRegionOfInterest(const ofRectangle &region, float scale) {
+		if(impl_) impl_->setRegionOfInterest(region, scale);
+		if(pending_) pending_->setRegionOfInterest(region, scale);
+	}
 	
-	ofTexture& getTexture() override { return impl_->getTexture(); }
-	const ofTexture& getTexture() const override { return impl_->getTexture(); };
-	void setUseTexture(bool bUseTex) override { impl_->setUseTexture(bUseTex); }
-	bool isUsingTexture() const override { return impl_->isUsingTexture(); }
+	ofTexture& getTexture() override { return impl_ ? impl_->getTexture() : empty_; }
+	const ofTexture& getTexture() const override { return impl_ ? impl_->getTexture() : empty_; };
+	void setUseTexture(bool bUseTex) override { if(impl_) impl_->setUseTexture(bUseTex); }
+	bool isUsingTexture() const override { return impl_ && impl_->isUsingTexture(); }
 
 protected:
-	std::shared_ptr<ImageSourceImpl> impl_;
+	std::shared_ptr<ImageSourceImpl> impl_, pending_;
+	ofTexture empty_;
+	void setImpl(std::shared_ptr<ImageSourceImpl> impl) {
+		impl_ = impl;
+		pending_ = nullptr;
+	}
 };
 
 namespace {
@@ -39,6 +68,9 @@ class NDIGrabber : public ImageSourceImpl, public ofxNDIVideoGrabber
 public:
 	template<typename T>
 	bool setup(T &&t) {
+		// frames go through our own buffers instead of the grabber's synchronous upload
+		ofVideoGrabber::setUseTexture(false);
+		uploader_.setup();
 		return ofxNDIVideoGrabber::setup(std::forward<T>(t));
 	}
 	template<>
@@ -59,15 +91,22 @@ public:
 		};
 
 		auto result = findSource(name_or_url);
-		if(result.second) {
-			ofxNDIVideoGrabber::setup(result.first);
+		return result.second && setup(result.first);
+	}
+	void update() override {
+		ofxNDIVideoGrabber::update();
+		if(ofxNDIVideoGrabber::isFrameNew()) {
+			uploader_.push(ofVideoGrabber::getPixels());
 		}
-		return result.second;
+		is_frame_new_ = uploader_.upload();
 	}
-	void update() override { ofxNDIVideoGrabber::update(); }
-	bool isFrameNew() const override { return ofxNDIVideoGrabber::isFrameNew(); }
-	ofTexture& getTexture() override { return ofVideoGrabber::getTexture(); }
-	const ofTexture& getTexture() const override { return ofVideoGrabber::getTexture(); };
+	bool isFrameNew() const override { return is_frame_new_; }
+	bool getUploadStats(UploadRing::Stats &stats) const override { stats = uploader_.getStats(); return true; }
+	ofTexture& getTexture() override { return uploader_.getTexture(); }
+	const ofTexture& getTexture() const override { return uploader_.getTexture(); };
+private:
+	PixelUploader uploader_;
+	bool is_frame_new_=false;
 };
 }
 template<typename T>
@@ -76,7 +115,7 @@ bool ImageSource::setupNDI(T &&source)
 	auto impl = std::make_shared<NDIGrabber>();
 	bool ret = impl->setup(source);
 	if(ret) {
-		impl_ = impl;
+		setImpl(impl);
 	}
 	return ret;
 }
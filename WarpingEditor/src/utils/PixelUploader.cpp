@@ -0,0 +1,65 @@
+#include "PixelUploader.h"
+#include "ofGLUtils.h"
+#include "ofUtils.h"
+
+void PixelUploader::setup(std::size_t num_buffers)
+{
+	ring_.resize(num_buffers);
+	buffers_.clear();
+	format_ = Format();
+}
+
+void PixelUploader::allocate(const Format &format)
+{
+	format_ = format;
+	ring_.resize(ring_.size());
+	buffers_.resize(ring_.size());
+	for(auto &&b : buffers_) {
+		b.allocate(format.total_bytes, GL_STREAM_DRAW);
+	}
+	texture_.allocate(format.width, format.height, format.gl_internal_format, ofGetUsingArbTex(), format.gl_format, format.gl_type);
+}
+
+void PixelUploader::push(const ofPixels &pixels)
+{
+	if(!pixels.isAllocated()) {
+		return;
+	}
+	Format format;
+	format.width = pixels.getWidth();
+	format.height = pixels.getHeight();
+	format.gl_format = ofGetGLFormat(pixels);
+	format.gl_type = ofGetGLType(pixels);
+	format.gl_internal_format = ofGetGLInternalFormat(pixels);
+	format.bytes_per_channel = pixels.getBytesPerChannel();
+	format.num_channels = pixels.getNumChannels();
+	format.total_bytes = pixels.getTotalBytes();
+	if(!(format == format_) || buffers_.size() != ring_.size()) {
+		allocate(format);
+	}
+	int slot = ring_.acquireWrite();
+	if(slot == UploadRing::NONE) {
+		return;
+	}
+	auto &&buffer = buffers_[slot];
+	auto dst = buffer.map<unsigned char>(GL_WRITE_ONLY);
+	if(!dst) {
+		ring_.cancelWrite(slot);
+		return;
+	}
+	memcpy(dst, pixels.getData(), format_.total_bytes);
+	buffer.unmap();
+	ring_.commitWrite(slot, ofGetElapsedTimef()*1000.);
+}
+
+bool PixelUploader::upload()
+{
+	int slot = ring_.acquireRead();
+	if(slot == UploadRing::NONE) {
+		return false;
+	}
+	ofSetPixelStoreiAlignment(GL_UNPACK_ALIGNMENT, format_.width, format_.bytes_per_channel, format_.num_channels);
+	texture_.loadData(buffers_[slot], format_.gl_format, format_.gl_type);
+	ring_.commitRead(slot, ofGetElapsedTimef()*1000.);
+	return true;
+}
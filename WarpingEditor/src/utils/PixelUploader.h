@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ofTexture.h"
+#include "ofBufferObject.h"
+#include "ofPixels.h"
+#include "UploadRing.h"
+
+// streams frames into a texture through a ring of pixel buffer objects.
+// push() copies into a mapped buffer that the GPU isn't reading from, upload() starts an asynchronous
+// copy from the oldest filled buffer into the texture, so the CPU copy of the next frame overlaps it.
+class PixelUploader
+{
+public:
+	void setup(std::size_t num_buffers=3);
+	void push(const ofPixels &pixels);
+	bool upload();
+
+	ofTexture& getTexture() { return texture_; }
+	const ofTexture& getTexture() const { return texture_; }
+	UploadRing::Stats getStats() const { return ring_.getStats(); }
+private:
+	UploadRing ring_;
+	std::vector<ofBufferObject> buffers_;
+	ofTexture texture_;
+	struct Format {
+		int width=0, height=0;
+		int gl_format=0, gl_type=0, gl_internal_format=0;
+		int bytes_per_channel=0, num_channels=0;
+		std::size_t total_bytes=0;
+		bool operator==(const Format &f) const {
+			return width == f.width && height == f.height
+			&& gl_format == f.gl_format && gl_type == f.gl_type && gl_internal_format == f.gl_internal_format;
+		}
+	} format_;
+	void allocate(const Format &format);
+};
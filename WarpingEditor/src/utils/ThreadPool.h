@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+// fixed number of worker threads running pushed tasks in order.
+// tasks not started yet are dropped on destruction; running ones are waited for.
+class ThreadPool
+{
+public:
+	explicit ThreadPool(std::size_t num_threads=std::max(1u, std::thread::hardware_concurrency())) {
+		for(std::size_t i = 0; i < num_threads; ++i) {
+			threads_.emplace_back([this]{ threadedFunction(); });
+		}
+	}
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			tasks_.clear();
+			is_exiting_ = true;
+		}
+		cv_.notify_all();
+		for(auto &&t : threads_) {
+			t.join();
+		}
+	}
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void push(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			tasks_.push_back(std::move(task));
+		}
+		cv_.notify_one();
+	}
+	std::size_t getNumThreads() const { return threads_.size(); }
+private:
+	std::vector<std::thread> threads_;
+	std::deque<std::function<void()>> tasks_;
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	bool is_exiting_=false;
+
+	void threadedFunction() {
+		while(true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				cv_.wait(lock, [this]{ return is_exiting_ || !tasks_.empty(); });
+				if(is_exiting_) {
+					return;
+				}
+				task = std::move(tasks_.front());
+				tasks_.pop_front();
+			}
+			task();
+		}
+	}
+};
@@ -0,0 +1,165 @@
+#include "TiledTexture.h"
+#include "ofGLUtils.h"
+#include "ofLog.h"
+#include <thread>
+#include <cmath>
+
+namespace {
+// 2x2 box filter, clamped at the right and bottom edges of odd sized images
+void downsample(const ofPixels &src, ofPixels &dst, std::size_t row_begin, std::size_t row_end) {
+	const std::size_t channels = src.getNumChannels();
+	const std::size_t src_w = src.getWidth(), src_h = src.getHeight();
+	const std::size_t dst_w = dst.getWidth();
+	const unsigned char *s = src.getData();
+	unsigned char *d = dst.getData();
+	for(std::size_t y = row_begin; y < row_end; ++y) {
+		std::size_t y0 = y*2, y1 = std::min(y0+1, src_h-1);
+		for(std::size_t x = 0; x < dst_w; ++x) {
+			std::size_t x0 = x*2, x1 = std::min(x0+1, src_w-1);
+			for(std::size_t c = 0; c < channels; ++c) {
+				unsigned sum = s[(y0*src_w+x0)*channels+c] + s[(y0*src_w+x1)*channels+c]
+				+ s[(y1*src_w+x0)*channels+c] + s[(y1*src_w+x1)*channels+c];
+				d[(y*dst_w+x)*channels+c] = (sum+2)/4;
+			}
+		}
+	}
+}
+}
+
+std::vector<ofPixels> TiledTexture::buildPyramid(ofPixels &&base)
+{
+	std::vector<ofPixels> levels;
+	levels.push_back(std::move(base));
+	std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+	while(std::max(levels.back().getWidth(), levels.back().getHeight()) > TILE_SIZE) {
+		const ofPixels &src = levels.back();
+		ofPixels dst;
+		dst.allocate((src.getWidth()+1)/2, (src.getHeight()+1)/2, src.getPixelFormat());
+		std::size_t rows = dst.getHeight();
+		std::vector<std::thread> threads;
+		for(std::size_t i = 0; i < num_threads; ++i) {
+			std::size_t begin = rows*i/num_threads, end = rows*(i+1)/num_threads;
+			if(begin < end) {
+				threads.emplace_back([&src, &dst, begin, end]() { downsample(src, dst, begin, end); });
+			}
+		}
+		for(auto &&t : threads) {
+			t.join();
+		}
+		levels.push_back(std::move(dst));
+	}
+	return levels;
+}
+
+void TiledTexture::setup(std::vector<ofPixels> &&levels)
+{
+	levels_ = std::move(levels);
+	level_ = -1;
+	GLint max_size = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+	min_level_ = 0;
+	while(min_level_+1 < (int)levels_.size()
+		  && std::max(levels_[min_level_].getWidth(), levels_[min_level_].getHeight()) > (std::size_t)max_size) {
+		++min_level_;
+	}
+}
+
+void TiledTexture::allocate(int level)
+{
+	auto &&pix = levels_[level];
+	// always normalized coordinates; the logical size below would not fit rectangle textures
+	texture_.allocate(pix.getWidth(), pix.getHeight(), ofGetGLInternalFormat(pix), false, ofGetGLFormat(pix), ofGetGLType(pix));
+	auto &&data = texture_.getTextureData();
+	data.width = data.tex_w = levels_[0].getWidth();
+	data.height = data.tex_h = levels_[0].getHeight();
+	data.tex_t = data.tex_u = 1;
+	level_ = level;
+	cols_ = (pix.getWidth()+TILE_SIZE-1)/TILE_SIZE;
+	rows_ = (pix.getHeight()+TILE_SIZE-1)/TILE_SIZE;
+	is_uploaded_.assign(cols_*rows_, false);
+	clear();
+}
+
+void TiledTexture::clear()
+{
+	// through a framebuffer; glClearTexImage needs GL 4.4
+	auto &&data = texture_.getTextureData();
+	GLint previous = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+	GLfloat color[4];
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, color);
+	GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+	GLuint fbo = 0;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, data.textureTarget, data.textureID, 0);
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+		glDisable(GL_SCISSOR_TEST);
+		glClearColor(0, 0, 0, 0);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glClearColor(color[0], color[1], color[2], color[3]);
+		if(scissor) {
+			glEnable(GL_SCISSOR_TEST);
+		}
+	}
+	else {
+		ofLogWarning("TiledTexture") << "can't clear this format; tiles not uploaded yet show undefined texels";
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, previous);
+	glDeleteFramebuffers(1, &fbo);
+}
+
+bool TiledTexture::update(const ofRectangle &region, float scale, std::size_t max_tiles_per_frame)
+{
+	if(levels_.empty()) {
+		return false;
+	}
+	bool is_whole = region.width <= 0 || region.height <= 0;
+	int level = (int)levels_.size()-1;
+	if(scale > 0) {
+		// the coarsest level that still has at least one texel per screen pixel
+		int wanted = (int)std::floor(std::log2(1/scale));
+		level = std::max(min_level_, std::min(wanted, level));
+	}
+	bool is_reallocated = false;
+	if(level != level_) {
+		allocate(level);
+		is_reallocated = true;
+	}
+	float div = 1<<level_;
+	int col0 = 0, row0 = 0, col1 = cols_-1, row1 = rows_-1;
+	if(!is_whole) {
+		col0 = std::max(col0, (int)std::floor(region.getLeft()/div/TILE_SIZE));
+		row0 = std::max(row0, (int)std::floor(region.getTop()/div/TILE_SIZE));
+		col1 = std::min(col1, (int)std::floor(region.getRight()/div/TILE_SIZE));
+		row1 = std::min(row1, (int)std::floor(region.getBottom()/div/TILE_SIZE));
+	}
+	std::size_t uploaded = 0;
+	for(int row = row0; row <= row1 && uploaded < max_tiles_per_frame; ++row) {
+		for(int col = col0; col <= col1 && uploaded < max_tiles_per_frame; ++col) {
+			if(!is_uploaded_[row*cols_+col]) {
+				uploadTile(col, row);
+				++uploaded;
+			}
+		}
+	}
+	return is_reallocated;
+}
+
+void TiledTexture::uploadTile(int col, int row)
+{
+	auto &&pix = levels_[level_];
+	int x = col*TILE_SIZE, y = row*TILE_SIZE;
+	int w = std::min<int>(TILE_SIZE, pix.getWidth()-x);
+	int h = std::min<int>(TILE_SIZE, pix.getHeight()-y);
+	auto &&data = texture_.getTextureData();
+	glBindTexture(data.textureTarget, data.textureID);
+	ofSetPixelStoreiAlignment(GL_UNPACK_ALIGNMENT, pix.getWidth(), pix.getBytesPerChannel(), pix.getNumChannels());
+	// a sub rectangle straight out of the level's pixels
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, pix.getWidth());
+	glTexSubImage2D(data.textureTarget, 0, x, y, w, h, ofGetGLFormat(pix), ofGetGLType(pix),
+					pix.getData() + ((std::size_t)y*pix.getWidth()+x)*pix.getBytesPerPixel());
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glBindTexture(data.textureTarget, 0);
+	is_uploaded_[row*cols_+col] = true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ofTexture.h"
+#include "ofPixels.h"
+#include "ofRectangle.h"
+
+// shows a still that is too large for one texture(or wasteful as one) through a mip pyramid of tiles.
+// only one level is resident, the coarsest that still gives the requested detail. the texture covers the
+// whole image at that level, but only tiles inside the region of interest are uploaded; it is cleared when
+// allocated, so tiles not uploaded yet are transparent. its width/height report the full resolution size,
+// so texture coordinates and sizes computed by the editors don't depend on which level is resident.
+class TiledTexture
+{
+public:
+	static constexpr int TILE_SIZE = 1024;
+	// level 0 is base itself, each next one is half the size; stops once a level fits in one tile.
+	// heavy, meant to run on a worker thread.
+	static std::vector<ofPixels> buildPyramid(ofPixels &&base);
+
+	void setup(std::vector<ofPixels> &&levels);
+	// region in full resolution pixels(empty means everything), scale in screen pixels per image pixel
+	// (0 when nothing is shown, which keeps the coarsest level).
+	// returns true if the texture was reallocated, i.e. copies of it have to be fetched again.
+	bool update(const ofRectangle &region, float scale, std::size_t max_tiles_per_frame=4);
+
+	ofTexture& getTexture() { return texture_; }
+	const ofTexture& getTexture() const { return texture_; }
+	int getLevel() const { return level_; }
+	std::size_t getNumLevels() const { return levels_.size(); }
+private:
+	std::vector<ofPixels> levels_;
+	ofTexture texture_;
+	int level_=-1;
+	int min_level_=0;
+	int cols_=0, rows_=0;
+	std::vector<bool> is_uploaded_;
+
+	void allocate(int level);
+	void clear();
+	void uploadTile(int col, int row);
+};
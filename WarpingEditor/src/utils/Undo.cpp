@@ -62,8 +62,7 @@ Undo::DataType Undo::createUndo() const
 }
 void Undo::loadUndo(const DataType &data)
 {
-	std::stringstream stream(data);
-	app_->unpackDataFile(stream);
+	app_->unpackDataFile(data.data(), data.size());
 	cache_ = data;
 }
 
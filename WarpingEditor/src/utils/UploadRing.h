@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// slot bookkeeping for a ring of upload buffers. knows nothing about GL so it can be reasoned about on its own.
+// a slot goes FREE -> WRITING -> READY -> READING -> FREE.
+// a READING slot is only released when the next read is committed, because the GPU may still be copying from it.
+class UploadRing
+{
+public:
+	static constexpr int NONE = -1;
+	struct Stats {
+		std::uint64_t pushed=0;
+		std::uint64_t uploaded=0;
+		std::uint64_t dropped=0;
+		float latency_ms=0;		// smoothed time from commitWrite to commitRead
+		float max_latency_ms=0;
+		std::size_t num_ready=0;
+	};
+	explicit UploadRing(std::size_t size=3) { resize(size); }
+	void resize(std::size_t size) {
+		slots_.assign(std::max<std::size_t>(size, 2), Slot{});
+		write_cursor_ = 0;
+		serial_ = 0;
+	}
+	std::size_t size() const { return slots_.size(); }
+
+	// a slot the producer can fill. if every slot is taken, the oldest frame nobody has read yet is dropped.
+	int acquireWrite() {
+		for(std::size_t i = 0; i < slots_.size(); ++i) {
+			auto index = (write_cursor_+i)%slots_.size();
+			if(slots_[index].state == FREE) {
+				return begin(index);
+			}
+		}
+		int oldest = findOldest(READY);
+		if(oldest != NONE) {
+			++stats_.dropped;
+			return begin(oldest);
+		}
+		return NONE;
+	}
+	void commitWrite(int slot, double time_ms) {
+		auto &&s = slots_[slot];
+		s.state = READY;
+		s.serial = serial_++;
+		s.time_ms = time_ms;
+		write_cursor_ = (slot+1)%slots_.size();
+		++stats_.pushed;
+	}
+	// gives back a slot that couldn't be filled; the frame counts as dropped
+	void cancelWrite(int slot) {
+		slots_[slot].state = FREE;
+		++stats_.dropped;
+	}
+	// the oldest frame ready for upload
+	int acquireRead() const {
+		return findOldest(READY);
+	}
+	void commitRead(int slot, double time_ms) {
+		for(auto &&s : slots_) {
+			if(s.state == READING) {
+				s.state = FREE;
+			}
+		}
+		auto &&s = slots_[slot];
+		s.state = READING;
+		++stats_.uploaded;
+		float latency = static_cast<float>(time_ms - s.time_ms);
+		stats_.latency_ms = stats_.uploaded == 1 ? latency : stats_.latency_ms*0.9f + latency*0.1f;
+		stats_.max_latency_ms = std::max(stats_.max_latency_ms, latency);
+	}
+	Stats getStats() const {
+		Stats ret = stats_;
+		ret.num_ready = std::count_if(std::begin(slots_), std::end(slots_), [](const Slot &s) { return s.state == READY; });
+		return ret;
+	}
+	void resetStats() { stats_ = Stats(); }
+private:
+	enum State { FREE, WRITING, READY, READING };
+	struct Slot {
+		State state=FREE;
+		std::uint64_t serial=0;
+		double time_ms=0;
+	};
+	std::vector<Slot> slots_;
+	std::size_t write_cursor_=0;
+	std::uint64_t serial_=0;
+	Stats stats_;
+
+	int begin(std::size_t index) {
+		slots_[index].state = WRITING;
+		return static_cast<int>(index);
+	}
+	int findOldest(State state) const {
+		int ret = NONE;
+		for(std::size_t i = 0; i < slots_.size(); ++i) {
+			if(slots_[i].state == state && (ret == NONE || slots_[i].serial < slots_[ret].serial)) {
+				ret = static_cast<int>(i);
+			}
+		}
+		return ret;
+	}
+};
@@ -0,0 +1,161 @@
+#include "VideoDecoder.h"
+#include "ofUtils.h"
+#include "ofLog.h"
+
+bool VideoDecoder::load(const std::filesystem::path &filepath, std::size_t queue_size)
+{
+	close();
+	capacity_ = std::max<std::size_t>(queue_size, 2);
+	queue_.clear();
+	recycled_.clear();
+	stats_ = Stats();
+	next_time_ = 0;
+	load_state_ = LOADING;
+	is_running_ = true;
+	thread_ = std::thread(&VideoDecoder::threadedFunction, this, filepath);
+	std::unique_lock<std::mutex> lock(mutex_);
+	cv_.wait(lock, [this]{ return load_state_ != LOADING; });
+	if(load_state_ == FAILED) {
+		lock.unlock();
+		close();
+		return false;
+	}
+	return true;
+}
+
+void VideoDecoder::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		is_running_ = false;
+	}
+	cv_.notify_all();
+	if(thread_.joinable()) {
+		thread_.join();
+	}
+}
+
+bool VideoDecoder::waitForFrame(ofVideoPlayer &player)
+{
+	auto start = ofGetElapsedTimeMillis();
+	while(is_running_ && ofGetElapsedTimeMillis()-start < 1000) {
+		player.update();
+		if(player.isFrameNew()) {
+			return true;
+		}
+		if(player.getIsMovieDone()) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+void VideoDecoder::threadedFunction(std::filesystem::path filepath)
+{
+	ofVideoPlayer player;
+	// the decode thread only needs pixels, textures stay on the GL thread
+	player.setUseTexture(false);
+	bool loaded = player.load(filepath.string());
+	if(loaded) {
+		player.setLoopState(OF_LOOP_NONE);
+		player.play();
+		player.setPaused(true);
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if(loaded) {
+			auto duration = player.getDuration();
+			auto num_frames = player.getTotalNumFrames();
+			frame_duration_ = duration > 0 && num_frames > 0 ? duration/num_frames : 1/30.;
+		}
+		load_state_ = loaded ? LOADED : FAILED;
+	}
+	cv_.notify_all();
+	if(!loaded) {
+		return;
+	}
+	std::uint64_t index = 0, index_in_loop = 0;
+	while(is_running_) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cv_.wait(lock, [this]{ return !is_running_ || queue_.size() < capacity_; });
+			if(!is_running_) {
+				break;
+			}
+		}
+		if(index_in_loop > 0) {
+			player.nextFrame();
+		}
+		if(!waitForFrame(player)) {
+			if(!is_running_) {
+				break;
+			}
+			if(index_in_loop == 0) {
+				ofLogError("VideoDecoder") << "no frame could be decoded";
+				break;
+			}
+			// looping; frame times keep counting up so the render clock never has to jump back
+			player.firstFrame();
+			index_in_loop = 0;
+			continue;
+		}
+		Frame frame;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(!recycled_.empty()) {
+				frame.pixels = std::move(recycled_.back());
+				recycled_.pop_back();
+			}
+		}
+		// reuses the recycled allocation as long as the frame size doesn't change
+		frame.pixels = player.getPixels();
+		frame.time = index*frame_duration_;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			queue_.push_back(std::move(frame));
+			++stats_.decoded;
+		}
+		++index;
+		++index_in_loop;
+	}
+	player.close();
+}
+
+bool VideoDecoder::present(double clock, ofPixels &dst)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if(queue_.empty()) {
+		// before the first frame nothing is due yet. a long stall counts once per frame it misses
+		if(stats_.presented > 0 && clock >= next_time_) {
+			++stats_.underrun;
+			next_time_ += frame_duration_;
+		}
+		return false;
+	}
+	if(queue_.front().time > clock) {
+		return false;
+	}
+	while(queue_.size() > 1 && queue_[1].time <= clock) {
+		recycled_.push_back(std::move(queue_.front().pixels));
+		queue_.pop_front();
+		++stats_.late;
+	}
+	next_time_ = queue_.front().time+frame_duration_;
+	dst.swap(queue_.front().pixels);
+	recycled_.push_back(std::move(queue_.front().pixels));
+	queue_.pop_front();
+	++stats_.presented;
+	lock.unlock();
+	cv_.notify_one();
+	return true;
+}
+
+VideoDecoder::Stats VideoDecoder::getStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Stats ret = stats_;
+	ret.queue_depth = queue_.size();
+	ret.queue_capacity = capacity_;
+	return ret;
+}
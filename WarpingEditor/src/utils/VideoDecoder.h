@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ofVideoPlayer.h"
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// decodes a video ahead of time on its own thread into a bounded queue of frames.
+// the render thread asks for the frame belonging to its clock, so uneven decode times
+// are absorbed by the queue instead of showing up on screen.
+// the player is created, loaded, driven and closed on the decode thread only,
+// since the platform players aren't safe to use from more than one thread.
+class VideoDecoder
+{
+public:
+	struct Stats {
+		std::size_t queue_depth=0, queue_capacity=0;
+		std::uint64_t decoded=0;
+		std::uint64_t presented=0;
+		std::uint64_t late=0;		// due frames skipped because a newer one was also due
+		std::uint64_t underrun=0;	// frame periods that passed with the queue empty
+	};
+	~VideoDecoder() { close(); }
+
+	// blocks until the decode thread has opened the file
+	bool load(const std::filesystem::path &filepath, std::size_t queue_size=8);
+	void close();
+	// moves the newest frame due at `clock`(seconds from the start, keeps growing across loops) into dst.
+	// the buffer dst held before is recycled for decoding. returns false if no new frame is due.
+	bool present(double clock, ofPixels &dst);
+	double getFrameDuration() const { return frame_duration_; }
+	Stats getStats() const;
+private:
+	struct Frame {
+		ofPixels pixels;
+		double time;
+	};
+	enum LoadState { LOADING, LOADED, FAILED };
+	LoadState load_state_=LOADING;
+	std::thread thread_;
+	mutable std::mutex mutex_;
+	std::condition_variable cv_;
+	std::deque<Frame> queue_;
+	std::vector<ofPixels> recycled_;
+	std::size_t capacity_=0;
+	std::atomic<bool> is_running_{false};
+	double frame_duration_=1/30.;
+	// pts of the frame the render clock waits for next
+	double next_time_=0;
+	Stats stats_;
+
+	void threadedFunction(std::filesystem::path filepath);
+	bool waitForFrame(ofVideoPlayer &player);
+};
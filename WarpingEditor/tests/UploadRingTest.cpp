@@ -0,0 +1,134 @@
+#include "UploadRing.h"
+#include <cstdio>
+#include <cmath>
+
+namespace {
+int num_failed = 0;
+#define CHECK(expr) do { if(!(expr)) { std::printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #expr); ++num_failed; } } while(0)
+
+// writes one frame and returns its slot
+int write(UploadRing &ring, double time_ms)
+{
+	int slot = ring.acquireWrite();
+	if(slot != UploadRing::NONE) {
+		ring.commitWrite(slot, time_ms);
+	}
+	return slot;
+}
+// reads the oldest frame and returns its slot
+int read(UploadRing &ring, double time_ms)
+{
+	int slot = ring.acquireRead();
+	if(slot != UploadRing::NONE) {
+		ring.commitRead(slot, time_ms);
+	}
+	return slot;
+}
+
+void testOrder()
+{
+	UploadRing ring(3);
+	int a = write(ring, 0);
+	int b = write(ring, 1);
+	CHECK(a != b);
+	CHECK(read(ring, 2) == a);
+	int c = write(ring, 3);
+	CHECK(c != a);	// a is still being read from
+	CHECK(read(ring, 4) == b);
+	CHECK(read(ring, 5) == c);
+	auto stats = ring.getStats();
+	CHECK(stats.pushed == 3);
+	CHECK(stats.uploaded == 3);
+	CHECK(stats.dropped == 0);
+}
+
+void testOverwriteBeforeRead()
+{
+	UploadRing ring(3);
+	int a = write(ring, 0);
+	int b = write(ring, 1);
+	int c = write(ring, 2);
+	CHECK(ring.getStats().num_ready == 3);
+	// every slot holds an unread frame, so the oldest one gives way
+	int d = write(ring, 3);
+	CHECK(d == a);
+	CHECK(ring.getStats().dropped == 1);
+	CHECK(read(ring, 4) == b);
+	CHECK(read(ring, 5) == c);
+	CHECK(read(ring, 6) == d);
+	CHECK(ring.getStats().dropped == 1);
+}
+
+void testEmpty()
+{
+	UploadRing ring(3);
+	CHECK(ring.acquireRead() == UploadRing::NONE);
+	write(ring, 0);
+	read(ring, 1);
+	// the slot being read from isn't ready again
+	CHECK(ring.acquireRead() == UploadRing::NONE);
+	CHECK(ring.getStats().num_ready == 0);
+}
+
+void testFull()
+{
+	UploadRing ring(1);
+	CHECK(ring.size() == 2);
+	write(ring, 0);
+	read(ring, 1);
+	int writing = ring.acquireWrite();
+	CHECK(writing != UploadRing::NONE);
+	// one slot is read from, the other is being written: nothing to hand out or drop
+	CHECK(ring.acquireWrite() == UploadRing::NONE);
+	CHECK(ring.getStats().dropped == 0);
+	ring.commitWrite(writing, 2);
+	CHECK(read(ring, 3) == writing);
+	// reading the new frame released the old slot
+	CHECK(ring.acquireWrite() != UploadRing::NONE);
+}
+
+void testCancel()
+{
+	UploadRing ring(2);
+	int slot = ring.acquireWrite();
+	ring.cancelWrite(slot);
+	CHECK(ring.acquireRead() == UploadRing::NONE);
+	CHECK(ring.getStats().dropped == 1);
+	CHECK(ring.getStats().pushed == 0);
+	CHECK(write(ring, 0) != UploadRing::NONE);
+	CHECK(write(ring, 1) != UploadRing::NONE);
+}
+
+void testLatency()
+{
+	UploadRing ring(3);
+	write(ring, 10);
+	read(ring, 25);
+	auto stats = ring.getStats();
+	CHECK(std::abs(stats.latency_ms-15) < 1e-4f);
+	CHECK(std::abs(stats.max_latency_ms-15) < 1e-4f);
+	write(ring, 30);
+	read(ring, 32);
+	stats = ring.getStats();
+	CHECK(std::abs(stats.latency_ms-(15*0.9f+2*0.1f)) < 1e-4f);
+	CHECK(std::abs(stats.max_latency_ms-15) < 1e-4f);
+	ring.resetStats();
+	CHECK(ring.getStats().uploaded == 0);
+}
+}
+
+int main()
+{
+	testOrder();
+	testOverwriteBeforeRead();
+	testEmpty();
+	testFull();
+	testCancel();
+	testLatency();
+	if(num_failed > 0) {
+		std::printf("%d checks failed\n", num_failed);
+		return 1;
+	}
+	std::printf("all passed\n");
+	return 0;
+}
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+# writes the golden render fixtures: a project folder per case with its .maap and the images
+# `render` must produce from input.png. the cases are simple enough that the expected images are
+# computed here from their definition, not by the renderer under test.
+#   identity  one warp mesh mapping the input onto the bridge as it is, nothing to blend
+#   mirror    the same with the uv quad flipped horizontally, through a blending mesh without edges
+#   overlap   the identity warp through a blending mesh with left and right edges, gamma and base_color
+#   projectors  the identity warp through two blending meshes overlapping by a quarter of the bridge,
+#             each output ramped by its own mesh
+# usage: make_fixtures.py [folder](default: next to this script)
+import json
+import math
+import os
+import struct
+import sys
+import zlib
+
+WIDTH, HEIGHT = 64, 32
+
+
+class Writer:
+    # ByteWriter: little endian, arrays aligned to 16 within the chunk
+    def __init__(self):
+        self.buf = bytearray()
+
+    def align(self, n=16):
+        self.buf += bytes(-len(self.buf) % n)
+
+    def put(self, fmt, *values):
+        self.buf += struct.pack('<' + fmt, *values)
+
+    def put_array(self, fmt, values):
+        self.align()
+        self.buf += struct.pack('<%d%s' % (len(values), fmt), *values)
+
+
+def put_records(w, records):
+    # DataContainer
+    w.put('Q', len(records))
+    for name, pack in records:
+        w.put('I', len(name))
+        w.buf += name.encode()
+        w.align()
+        w.put_array('B', [0, 0, 0, 0])  # hidden, locked, solo
+        pack(w)
+
+
+def warp_record(uv_quad):
+    def pack(w):
+        w.put_array('f', [v for p in uv_quad for v in p])
+        w.put_array('I', [1, 1])
+        w.put_array('f', [0, 0, 0, WIDTH, 0, 0, 0, HEIGHT, 0, WIDTH, HEIGHT, 0])
+        w.put_array('f', [0, 0, 1, 0, 0, 1, 1, 1])
+        w.put_array('B', [0, 0, 0, 0])
+    return pack
+
+
+def blend_record(edges, outer, inner):
+    def pack(w):
+        w.put_array('B', edges)
+        for quad in (outer, inner):
+            w.put_array('f', [v for p in quad for v in p])
+    return pack
+
+
+def params_array(p):
+    return p['gamma'] + [p['luminance_control'], p['blend_power']] + p['base_color']
+
+
+def maap(chunks):
+    # SaveData v2
+    w = Writer()
+    w.buf += b'maap'
+    w.put('QIIQI', 2, 0x01020304, len(chunks), 32, 0)
+    directory = len(w.buf)
+    w.buf += bytes(24*len(chunks))
+    for i, (name, body) in enumerate(chunks):
+        w.align()
+        offset = len(w.buf)
+        w.buf += body
+        struct.pack_into('<4sIQQ', w.buf, directory+i*24, name, 0, offset, len(body))
+    return bytes(w.buf)
+
+
+def write_png(path, rows):
+    def chunk(tag, data):
+        return struct.pack('>I', len(data)) + tag + data + struct.pack('>I', zlib.crc32(tag+data))
+    raw = b''.join(b'\0' + bytes(v for px in row for v in px) for row in rows)
+    with open(path, 'wb') as f:
+        f.write(b'\x89PNG\r\n\x1a\n')
+        f.write(chunk(b'IHDR', struct.pack('>IIBBBBB', len(rows[0]), len(rows), 8, 2, 0, 0, 0)))
+        f.write(chunk(b'IDAT', zlib.compress(raw, 9)))
+        f.write(chunk(b'IEND', b''))
+
+
+def ramp(x, lum, power):
+    # blend::ramp
+    x = max(0.0, min(1.0, x))
+    return lum*(2*x)**power if x < 0.5 else 1-(1-lum)*(2*(1-x))**power
+
+
+def blended(value, gain, gamma, base):
+    # BlendMask::apply: lift scaled by 256 times the 16 bit gain, shifted back by 24 with rounding
+    lift = round((base+(1-base)*value/255)*255*256)
+    g = gain**(1/gamma) if gamma > 0 else (0.0 if gain < 1 else 1.0)
+    short = int(max(0.0, min(65535.0, g*65535+0.5)))
+    return (lift*short + (1 << 23)) >> 24
+
+
+def edge_position(s, lo, hi):
+    # getPosition for an axis aligned mesh with both edges on
+    if s < lo:
+        return s/lo
+    if s > hi:
+        return (1-s)/(1-hi)
+    return 1.0
+
+
+def main():
+    root = sys.argv[1] if len(sys.argv) > 1 else os.path.dirname(os.path.abspath(__file__))
+    source = [[((x*4+y) % 256, (y*8) % 256, (x*x+y*3) % 256) for x in range(WIDTH)] for y in range(HEIGHT)]
+    write_png(os.path.join(root, 'input.png'), source)
+
+    identity = [(0, 0), (1, 0), (0, 1), (1, 1)]
+    mirrored = [(1, 0), (0, 0), (1, 1), (0, 1)]
+    unit = [(0, 0), (1, 0), (0, 1), (1, 1)]
+    inner = [(0.25, 0), (0.75, 0), (0.25, 1), (0.75, 1)]
+    plain = {'gamma': [1.0, 1.0, 1.0], 'luminance_control': 0.5, 'blend_power': 2.0, 'base_color': [0.0, 0.0, 0.0]}
+    graded = {'gamma': [1.0, 1.8, 2.2], 'luminance_control': 0.5, 'blend_power': 2.0, 'base_color': [0.0, 0.0, 0.0625]}
+
+    def overlap(x, y):
+        gain = ramp(edge_position((x+0.5)/WIDTH, 0.25, 0.75), 0.5, 2.0)*ramp(1.0, 0.5, 2.0)
+        return tuple(blended(source[y][x][c], gain, graded['gamma'][c], graded['base_color'][c]) for c in range(3))
+
+    # left shows x in [0,40), right [24,64) of the bridge
+    span = 40
+    left_outer = [(0, 0), (0.625, 0), (0, 1), (0.625, 1)]
+    left_inner = [(0, 0), (0.375, 0), (0, 1), (0.375, 1)]
+    right_outer = [(0.375, 0), (1, 0), (0.375, 1), (1, 1)]
+    right_inner = [(0.625, 0), (1, 0), (0.625, 1), (1, 1)]
+
+    def projector(x0, lo, hi):
+        def expected(x, y):
+            gain = ramp(edge_position((x+0.5)/span, lo, hi), 0.5, 2.0)
+            return tuple(blended(source[y][x0+x][c], gain, 1.0, 0.0) for c in range(3))
+        return expected
+
+    # (uv quad, params, blending meshes, [(output, width, expected pixel)])
+    cases = {
+        'identity': (identity, plain, [], [('bridge', WIDTH, lambda x, y: source[y][x])]),
+        'mirror': (mirrored, plain, [('full', blend_record([0, 0, 0, 0], unit, unit))],
+                   [('full', WIDTH, lambda x, y: source[y][WIDTH-1-x])]),
+        'overlap': (identity, graded, [('edges', blend_record([1, 1, 0, 0], unit, inner))], [('edges', WIDTH, overlap)]),
+        'projectors': (identity, plain,
+                       [('left', blend_record([0, 1, 0, 0], left_outer, left_inner)),
+                        ('right', blend_record([1, 0, 0, 0], right_outer, right_inner))],
+                       [('left', span, projector(0, 0.0, 0.6)), ('right', span, projector(WIDTH-span, 0.4, 1.0))]),
+    }
+    for name, (uv_quad, params, blends, outputs) in cases.items():
+        folder = os.path.join(root, name)
+        os.makedirs(folder, exist_ok=True)
+        warp = Writer()
+        put_records(warp, [('warp', warp_record(uv_quad))])
+        blnd = Writer()
+        blnd.put_array('f', params_array(params))
+        put_records(blnd, blends)
+        with open(os.path.join(folder, 'fixture.maap'), 'wb') as f:
+            f.write(maap([(b'warp', bytes(warp.buf)), (b'blnd', bytes(blnd.buf))]))
+        project = {
+            'filename': 'fixture',
+            'bridge': {'resolution': [WIDTH, HEIGHT]},
+            'blend_params': params,
+            'texture': {'type': 'File', 'arg': '../input.png', 'size_cache': [WIDTH, HEIGHT]},
+        }
+        with open(os.path.join(folder, 'project.json'), 'w') as f:
+            json.dump(project, f, indent=4, sort_keys=True)
+            f.write('\n')
+        for output, width, expected in outputs:
+            os.makedirs(os.path.join(folder, 'expected', output), exist_ok=True)
+            write_png(os.path.join(folder, 'expected', output, '000000.png'),
+                      [[expected(x, y) for x in range(width)] for y in range(HEIGHT)])
+
+
+if __name__ == '__main__':
+    main()
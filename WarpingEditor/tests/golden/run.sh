@@ -0,0 +1,37 @@
+#!/bin/sh
+# renders every fixture here with the editor's `render` command and checks the results
+# against the expected images with `compare`. exits non-zero if any image is missing or differs.
+#	run.sh <path to the WarpingEditor executable> [tolerance(default: 1)]
+# the fixtures and expected images are written by make_fixtures.py.
+if [ $# -lt 1 ]; then
+	echo "usage: $0 <WarpingEditor executable> [tolerance]" >&2
+	exit 2
+fi
+editor=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+tolerance=${2:-1}
+here=$(cd "$(dirname "$0")" && pwd)
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+failed=0
+for fixture in "$here"/*/; do
+	name=$(basename "$fixture")
+	[ -d "$fixture/expected" ] || continue
+	if ! "$editor" render "$fixture" "$out/$name" "$here/input.png"; then
+		echo "FAILED to render: $name" >&2
+		failed=$((failed+1))
+		continue
+	fi
+	for expected in $(cd "$fixture/expected" && find . -name '*.png' | sed 's|^\./||' | sort); do
+		if "$editor" compare "$out/$name/$expected" "$fixture/expected/$expected" "$tolerance" "$out/$name/$expected.diff.png"; then
+			echo "ok: $name/$expected"
+		else
+			echo "FAILED: $name/$expected" >&2
+			failed=$((failed+1))
+		fi
+	done
+done
+if [ $failed -gt 0 ]; then
+	echo "$failed failed" >&2
+	exit 1
+fi